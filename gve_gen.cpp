@@ -0,0 +1,381 @@
+// Headless code generator: turns a saved graph into renderer.cpp without a window, GPU or ImGui frame.
+#include "vulkan_editor/batch.h"
+#include "vulkan_editor/graph.h"
+#include "vulkan_editor/mesh.h"
+#include "vulkan_editor/template_loader.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <thread>
+
+// --count-allocations: every global operator new is counted while this is on, the default new[] and delete forward here too
+static std::atomic<bool> countingAllocations{ false };
+static std::atomic<size_t> allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+    if (countingAllocations.load(std::memory_order_relaxed)) allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the inlined free with the library operator new and warns, both sides are ours here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static size_t countedAllocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+static void printUsage() {
+    std::cerr << "Usage: gve-gen <graph.json> [-o <output>] [--split] [--repeat <count>] [--benchmark] [--count-allocations] [--profile <report.json>]\n"
+              << "       gve-gen <graph.json>... --permutations <spec.json> [-o <output directory>] [--profile <report.json>]\n"
+              << "       gve-gen --benchmark-loader <model.obj> [--repeat <count>]\n";
+}
+
+// Renders every pipeline of the graph into memory with the render memo off, so each pass does the full work.
+// Pipelines render concurrently as well when parallel is on.
+static double benchmarkGeneration(TemplateLoader& templateLoader, const std::vector<PipelineNode*>& pipelines, int repeat, bool parallel) {
+    templateLoader.parallel = parallel;
+    size_t maxRenderedFragments = templateLoader.maxRenderedFragments;
+    templateLoader.maxRenderedFragments = 0;
+
+    size_t bytes = 0;
+    size_t allocations = countedAllocations();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        std::vector<FragmentTask> renderers;
+        for (PipelineNode* pipelineNode : pipelines) {
+            renderers.push_back(templateLoader.spawn([&templateLoader, pipelineNode] {
+                return pipelineNode->generateFragment(templateLoader, pipelineNode->settings.value());
+            }));
+        }
+        for (auto& renderer : renderers) {
+            FragmentPtr fragment = renderer.get();
+            if (!fragment) throw std::runtime_error("pipeline inputs are not connected");
+            std::ostringstream out;
+            fragment->writeTo(out);
+            bytes += out.tellp();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = countedAllocations() - allocations;
+
+    templateLoader.maxRenderedFragments = maxRenderedFragments;
+    double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << (parallel ? "parallel: " : "serial:   ") << totalMs << " ms, "
+              << bytes / repeat << " bytes per pass";
+    if (countingAllocations) std::cout << ", " << allocations / repeat << " allocations per pass";
+    std::cout << "\n";
+    return totalMs;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double timeDedup(const ObjData& obj, VertexDedup dedup, int repeat, MeshData& mesh) {
+    double bestMs = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeat; i++) {
+        auto start = std::chrono::steady_clock::now();
+        dedupVertices(obj, dedup, mesh);
+        bestMs = std::min(bestMs, elapsedMs(start));
+    }
+    return bestMs;
+}
+
+// Times each loadModel path on a copy of the model and on synthetic grids, so no cooked mesh lands next to the real assets
+static int benchmarkLoader(const std::string& modelPath, int repeat) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gve-loader-benchmark";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory, error);
+
+    std::vector<std::filesystem::path> objPaths = { directory / std::filesystem::path(modelPath).filename() };
+    std::filesystem::copy_file(modelPath, objPaths.front(), std::filesystem::copy_options::overwrite_existing, error);
+    if (error) {
+        std::cerr << "Could not copy " << modelPath << " to " << objPaths.front().string() << ": " << error.message() << "\n";
+        return 1;
+    }
+    for (size_t gridSize : { 256, 1024 }) {
+        objPaths.push_back(directory / ("grid_" + std::to_string(gridSize) + ".obj"));
+        if (!writeObj(makeGridObj(gridSize), objPaths.back().string())) return 1;
+    }
+
+    int result = 0;
+    for (const auto& objPath : objPaths) {
+        ObjData obj;
+        auto start = std::chrono::steady_clock::now();
+        if (!parseObj(objPath.string(), obj)) return 1;
+        double parseMs = elapsedMs(start);
+
+        MeshData hashMapMesh, flatMapMesh, cookedMesh;
+        double hashMapMs = timeDedup(obj, VertexDedup::HashMap, repeat, hashMapMesh);
+        double flatMapMs = timeDedup(obj, VertexDedup::FlatMap, repeat, flatMapMesh);
+
+        start = std::chrono::steady_clock::now();
+        if (!cookMesh(objPath.string(), false)) return 1;
+        double cookMs = elapsedMs(start);
+
+        double cookedMs = std::numeric_limits<double>::max();
+        for (int i = 0; i < repeat; i++) {
+            start = std::chrono::steady_clock::now();
+            if (!loadCookedMesh(objPath.string(), false, cookedMesh)) return 1;
+            cookedMs = std::min(cookedMs, elapsedMs(start));
+        }
+
+        bool same = hashMapMesh.indices == flatMapMesh.indices && cookedMesh.indices == flatMapMesh.indices &&
+            hashMapMesh.vertices.size() == flatMapMesh.vertices.size() && cookedMesh.vertices.size() == flatMapMesh.vertices.size() &&
+            std::memcmp(cookedMesh.vertices.data(), flatMapMesh.vertices.data(), flatMapMesh.vertices.size() * sizeof(MeshVertex)) == 0;
+        if (!same) {
+            std::cerr << objPath.filename().string() << ": loaded meshes differ\n";
+            result = 1;
+        }
+
+        std::cout << objPath.filename().string() << ": " << std::filesystem::file_size(objPath) / 1024 << " KiB, "
+                  << objIndexCount(obj) << " indices, " << flatMapMesh.vertices.size() << " unique vertices\n"
+                  << "  parse:               " << parseMs << " ms\n"
+                  << "  dedup unordered_map: " << hashMapMs << " ms\n"
+                  << "  dedup flat map:      " << flatMapMs << " ms (" << hashMapMs / flatMapMs << "x)\n"
+                  << "  cook:                " << cookMs << " ms\n"
+                  << "  cooked load:         " << cookedMs << " ms (" << (parseMs + hashMapMs) / cookedMs << "x the default loader)\n";
+
+        MeshData optimizedMesh = flatMapMesh;
+        start = std::chrono::steady_clock::now();
+        optimizeMesh(optimizedMesh);
+        double optimizeMs = elapsedMs(start);
+        std::cout << "  optimize:            " << optimizeMs << " ms\n";
+        for (size_t cacheSize : { 16, 32 }) {
+            std::cout << "  ACMR, FIFO " << cacheSize << ":       "
+                      << averageCacheMissRatio(flatMapMesh.indices, flatMapMesh.vertices.size(), cacheSize) << " -> "
+                      << averageCacheMissRatio(optimizedMesh.indices, optimizedMesh.vertices.size(), cacheSize) << "\n";
+        }
+
+        // Parallel loader from the file to the deduplicated mesh, twice the core count shows where scaling stops
+        double megabytes = std::filesystem::file_size(objPath) / (1024.0 * 1024.0);
+        unsigned maxThreads = 2 * std::max(2u, std::thread::hardware_concurrency());
+        for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+            MeshData parallelMesh;
+            double parallelMs = std::numeric_limits<double>::max();
+            for (int i = 0; i < repeat; i++) {
+                start = std::chrono::steady_clock::now();
+                if (!loadObjParallel(objPath.string(), threadCount, parallelMesh)) return 1;
+                parallelMs = std::min(parallelMs, elapsedMs(start));
+            }
+            if (parallelMesh.indices != flatMapMesh.indices || parallelMesh.vertices.size() != flatMapMesh.vertices.size() ||
+                std::memcmp(parallelMesh.vertices.data(), flatMapMesh.vertices.data(), flatMapMesh.vertices.size() * sizeof(MeshVertex)) != 0) {
+                std::cerr << objPath.filename().string() << ": parallel loader with " << threadCount << " threads differs\n";
+                result = 1;
+            }
+            std::cout << "  parallel, " << threadCount << (threadCount == 1 ? " thread:  " : " threads: ") << parallelMs << " ms, "
+                      << megabytes / (parallelMs / 1000.0) << " MB/s\n";
+        }
+    }
+
+    std::filesystem::remove_all(directory, error);
+    return result;
+}
+
+// Every graph gets all variants of the spec, each graph in its own directory when there are several
+static int runBatch(TemplateLoader& templateLoader, const std::vector<std::string>& graphPaths, const std::string& specPath, const std::string& outputDirectory) {
+    std::ifstream specFile(specPath);
+    if (!specFile.is_open()) {
+        std::cerr << "Error opening " << specPath << " for reading.\n";
+        return 1;
+    }
+    std::vector<inja::json> variants = expandPermutations(inja::json::parse(specFile));
+
+    BatchResult total;
+    for (const std::string& graphPath : graphPaths) {
+        std::vector<std::unique_ptr<Node>> nodes;
+        std::vector<Link> links;
+        int currentId = 1;
+        if (!loadGraph(graphPath, nodes, links, currentId)) return 1;
+
+        std::filesystem::path directory = outputDirectory;
+        if (graphPaths.size() > 1) directory /= std::filesystem::path(graphPath).stem();
+
+        BatchResult result = generateBatch(templateLoader, nodes, variants, directory.string());
+        total.written += result.written;
+        total.failed += result.failed;
+        total.seconds += result.seconds;
+    }
+
+    std::cout << total.written << " variants written to " << outputDirectory << " in " << total.seconds * 1000.0 << " ms, "
+              << total.written / std::max(total.seconds, 1e-9) << " variants/s\n";
+    if (total.failed > 0) {
+        std::cerr << total.failed << " variants failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Generates every pipeline of one graph, --repeat regenerates it to time the code generation alone
+static int runGraph(TemplateLoader& templateLoader, const std::string& graphPath, const std::string& outputPath, int repeat, bool benchmark, bool splitOutput) {
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<Link> links;
+    int currentId = 1;
+    if (!loadGraph(graphPath, nodes, links, currentId)) return 1;
+
+    std::vector<PipelineNode*> pipelines;
+    for (const auto& node : nodes) {
+        if (auto pipelineNode = dynamic_cast<PipelineNode*>(node.get())) {
+            pipelines.push_back(pipelineNode);
+        }
+    }
+
+    if (pipelines.empty()) {
+        std::cerr << "No pipeline node in " << graphPath << "\n";
+        return 1;
+    }
+
+    // Several pipelines get a file each, named after the pipeline node like the batch variants.
+    // A split project builds a single renderer, so it takes one pipeline.
+    std::vector<std::string> outputPaths;
+    if (pipelines.size() == 1) {
+        outputPaths.push_back(outputPath);
+    } else if (splitOutput) {
+        std::cerr << graphPath << " has " << pipelines.size() << " pipelines, --split needs a graph with one\n";
+        return 1;
+    } else {
+        std::filesystem::path path = outputPath;
+        for (PipelineNode* pipelineNode : pipelines) {
+            std::filesystem::path pipelinePath = path;
+            pipelinePath.replace_filename(path.stem().string() + "_" + std::to_string(pipelineNode->getId()) + path.extension().string());
+            outputPaths.push_back(pipelinePath.string());
+        }
+    }
+
+    if (benchmark) {
+        // One untimed pass parses the templates
+        benchmarkGeneration(templateLoader, pipelines, 1, false);
+        std::cout << pipelines.size() << " pipelines, " << repeat << " passes\n";
+        double serialMs = benchmarkGeneration(templateLoader, pipelines, repeat, false);
+        double parallelMs = benchmarkGeneration(templateLoader, pipelines, repeat, true);
+        std::cout << "speedup: " << serialMs / parallelMs << "x\n";
+        return 0;
+    }
+
+    // The first generation also parses the templates and fills the render memo, so it is reported on its own
+    std::vector<size_t> allocations;
+    allocations.reserve(repeat);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        size_t before = countedAllocations();
+        for (size_t j = 0; j < pipelines.size(); j++) {
+            if (!pipelines[j]->generate(templateLoader, pipelines[j]->settings.value(), outputPaths[j], splitOutput)) return 1;
+        }
+        allocations.push_back(countedAllocations() - before);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (const std::string& path : outputPaths) {
+        std::cout << "Code was successfully generated in " << path << "\n";
+    }
+    if (repeat > 1) {
+        double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << repeat << " generations in " << totalMs << " ms, " << totalMs / repeat << " ms each\n";
+    }
+    if (countingAllocations) {
+        std::cout << "allocations: " << allocations.front() << " in the first generation";
+        if (repeat > 1) {
+            size_t repeated = 0;
+            for (size_t i = 1; i < allocations.size(); i++) repeated += allocations[i];
+            std::cout << ", " << repeated / (repeat - 1) << " per generation after it";
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> graphPaths;
+    std::string outputPath;
+    std::string permutationsPath;
+    std::string profilePath;
+    std::string loaderModelPath;
+    int repeat = 1;
+    bool benchmark = false;
+    bool splitOutput = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (arg == "--split") {
+            splitOutput = true;
+        } else if (arg == "--benchmark") {
+            benchmark = true;
+        } else if (arg == "--count-allocations") {
+            countingAllocations = true;
+        } else if (arg == "--benchmark-loader" && i + 1 < argc) {
+            loaderModelPath = argv[++i];
+        } else if (arg == "--permutations" && i + 1 < argc) {
+            permutationsPath = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            graphPaths.push_back(arg);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!loaderModelPath.empty()) {
+        if (!graphPaths.empty()) {
+            printUsage();
+            return 1;
+        }
+        return benchmarkLoader(loaderModelPath, repeat);
+    }
+
+    // Variants share one directory, a split project per variant would fight over meson.build
+    if (graphPaths.empty() || (permutationsPath.empty() && graphPaths.size() > 1) || (splitOutput && !permutationsPath.empty())) {
+        printUsage();
+        return 1;
+    }
+
+    TemplateLoader templateLoader;
+    templateLoader.profiling = !profilePath.empty();
+    for (const std::string& fileName : templateFileNames) {
+        templateLoader.loadTemplateFile(fileName);
+    }
+
+    int result = 1;
+    try {
+        if (!permutationsPath.empty()) {
+            result = runBatch(templateLoader, graphPaths, permutationsPath, outputPath.empty() ? "variants" : outputPath);
+        } else {
+            result = runGraph(templateLoader, graphPaths.front(), outputPath.empty() ? "renderer.cpp" : outputPath, repeat, benchmark, splitOutput);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "gve-gen: " << e.what() << "\n";
+    }
+
+    if (templateLoader.profiling) {
+        templateLoader.printProfile(std::cout);
+        if (!templateLoader.writeProfile(profilePath)) result = 1;
+    }
+    return result;
+}
@@ -43,23 +43,6 @@ const bool enableValidationLayers = false;
 const bool enableValidationLayers = true;
 #endif
 
-const std::vector<std::string> templateFileNames = {
-	"vulkan_templates/class.txt",
-	"vulkan_templates/application.txt",
-	"vulkan_templates/buffer.txt",
-	"vulkan_templates/globalVariables.txt",
-	"vulkan_templates/header.txt",
-	"vulkan_templates/image.txt",
-	"vulkan_templates/instance.txt",
-	"vulkan_templates/logicalDevice.txt",
-	"vulkan_templates/model.txt",
-	"vulkan_templates/physicalDevice.txt",
-	"vulkan_templates/pipeline.txt",
-	"vulkan_templates/renderpass.txt",
-	"vulkan_templates/swapchain.txt",
-	"vulkan_templates/utils.txt",
-};
-
 Editor editor{templateFileNames};
 
 static void check_vk_result(VkResult err) {
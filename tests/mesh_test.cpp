@@ -0,0 +1,139 @@
+// Checks of the editor's mesh helpers and the loader stages they share with the generated renderer
+#include "../vulkan_editor/mesh.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+static bool sameMesh(const MeshData& a, const MeshData& b) {
+    return a.indices == b.indices && a.vertices.size() == b.vertices.size() &&
+        std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(MeshVertex)) == 0;
+}
+
+// Faces that only list positions have texcoord_index -1, every loader leaves their texCoord at zero
+static void testObjWithoutTexcoords(const std::filesystem::path& directory) {
+    std::filesystem::path objPath = directory / "no_texcoords.obj";
+    {
+        std::ofstream file(objPath);
+        file << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+             << "f 1 2 3\nf 1 3 4\n";
+    }
+
+    ObjData obj;
+    check(parseObj(objPath.string(), obj), "parse an OBJ without texcoords");
+    check(obj.attrib.texcoords.empty(), "no texcoords parsed");
+
+    MeshData hashMapMesh, flatMapMesh;
+    dedupVertices(obj, VertexDedup::HashMap, hashMapMesh);
+    dedupVertices(obj, VertexDedup::FlatMap, flatMapMesh);
+    check(hashMapMesh.vertices.size() == 4 && hashMapMesh.indices.size() == 6, "four vertices and six indices");
+    for (const MeshVertex& vertex : hashMapMesh.vertices) {
+        check(vertex.texCoord[0] == 0.0f && vertex.texCoord[1] == 0.0f, "zero texCoord without texcoords");
+    }
+    check(sameMesh(hashMapMesh, flatMapMesh), "unordered_map and flat map dedup agree");
+
+    for (unsigned threadCount : { 1u, 2u }) {
+        MeshData parallelMesh;
+        check(loadObjParallel(objPath.string(), threadCount, parallelMesh), "parallel load without texcoords");
+        check(sameMesh(parallelMesh, flatMapMesh), "parallel loader agrees with " + std::to_string(threadCount) + " threads");
+    }
+}
+
+// The renderer opens cooked meshes read only and rejects any whose counts do not match the file size
+static void testCookedMesh(const std::filesystem::path& directory) {
+    std::filesystem::path objPath = directory / "grid.obj";
+    check(writeObj(makeGridObj(8), objPath.string()), "write the grid OBJ");
+    check(cookMesh(objPath.string(), false), "cook the grid");
+
+    ObjData obj;
+    check(parseObj(objPath.string(), obj), "parse the grid");
+    MeshData parsedMesh, cookedMesh;
+    dedupVertices(obj, VertexDedup::FlatMap, parsedMesh);
+    std::filesystem::path cookedPath = gve::cookedMeshPath(objPath.string());
+    std::filesystem::permissions(cookedPath, std::filesystem::perms::owner_read, std::filesystem::perm_options::replace);
+    check(loadCookedMesh(objPath.string(), false, cookedMesh), "load a read only cooked mesh");
+    check(sameMesh(cookedMesh, parsedMesh), "cooked mesh matches the parsed one");
+    check(!loadCookedMesh(objPath.string(), true, cookedMesh), "reject a cooked mesh with other flags");
+    std::filesystem::permissions(cookedPath, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+        std::filesystem::perm_options::replace);
+
+    // Touched without changing, the hash still matches and the cook step stores the new time
+    auto touched = std::filesystem::last_write_time(objPath) + std::chrono::seconds(10);
+    std::filesystem::last_write_time(objPath, touched);
+    check(loadCookedMesh(objPath.string(), false, cookedMesh), "load after the OBJ was touched");
+    check(cookMesh(objPath.string(), false), "cook a touched OBJ");
+    {
+        std::ifstream cookedFile(cookedPath, std::ios::binary);
+        gve::CookedMeshHeader header{};
+        cookedFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+        check(header.sourceTime == touched.time_since_epoch().count(), "cook step refreshes the OBJ time");
+    }
+
+    uintmax_t cookedSize = std::filesystem::file_size(cookedPath);
+    std::filesystem::resize_file(cookedPath, cookedSize - sizeof(uint32_t));
+    check(!loadCookedMesh(objPath.string(), false, cookedMesh), "reject a truncated cooked mesh");
+    std::filesystem::resize_file(cookedPath, cookedSize + sizeof(uint32_t));
+    check(!loadCookedMesh(objPath.string(), false, cookedMesh), "reject a cooked mesh with trailing bytes");
+}
+
+// A grid wrapped around a sphere is one connected surface whose parts face different ways, the overdraw pass has to
+// split it into clusters and reorder them without giving up the vertex cache order
+static void testOverdrawReordersConnectedMesh() {
+    const size_t gridSize = 64;
+    ObjData obj = makeGridObj(gridSize);
+    for (size_t i = 0; i + 2 < obj.attrib.vertices.size(); i += 3) {
+        float longitude = obj.attrib.vertices[i] * 6.2831853f;
+        float latitude = (obj.attrib.vertices[i + 1] - 0.5f) * 3.0f;
+        obj.attrib.vertices[i] = std::cos(latitude) * std::cos(longitude);
+        obj.attrib.vertices[i + 1] = std::sin(latitude);
+        obj.attrib.vertices[i + 2] = std::cos(latitude) * std::sin(longitude);
+    }
+    MeshData mesh;
+    dedupVertices(obj, VertexDedup::FlatMap, mesh);
+
+    gve::optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    std::vector<uint32_t> cacheOrdered = mesh.indices;
+    gve::optimizeOverdraw(mesh.indices, mesh.vertices);
+    check(mesh.indices != cacheOrdered, "overdraw pass reorders a connected mesh");
+
+    auto sortedTriangles = [](const std::vector<uint32_t>& indices) {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    check(sortedTriangles(mesh.indices) == sortedTriangles(cacheOrdered), "overdraw pass keeps every triangle and its winding");
+
+    double before = averageCacheMissRatio(cacheOrdered, mesh.vertices.size(), gve::optimizerCacheSize);
+    double after = averageCacheMissRatio(mesh.indices, mesh.vertices.size(), gve::optimizerCacheSize);
+    std::cout << "overdraw pass on a sphere grid: ACMR " << before << " -> " << after << "\n";
+    check(after <= before * 1.1, "overdraw pass keeps the ACMR within 10%");
+}
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gve-mesh-test";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory);
+
+    testObjWithoutTexcoords(directory);
+    testCookedMesh(directory);
+    testOverdrawReordersConnectedMesh();
+
+    std::filesystem::remove_all(directory, error);
+    if (failures == 0) std::cout << "mesh tests passed\n";
+    return failures == 0 ? 0 : 1;
+}
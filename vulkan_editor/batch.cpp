@@ -0,0 +1,113 @@
+#include "batch.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+std::vector<inja::json> expandPermutations(const inja::json& spec) {
+	const inja::json defaults = PipelineSettings{};
+	std::vector<inja::json> variants = { inja::json::object() };
+
+	for (const auto& field : spec.items()) {
+		if (!defaults.contains(field.key())) {
+			throw std::invalid_argument("Unknown pipeline setting " + field.key());
+		}
+		if (!field.value().is_array() || field.value().empty()) {
+			throw std::invalid_argument("Values for " + field.key() + " must be a non-empty array");
+		}
+
+		std::vector<inja::json> expanded;
+		expanded.reserve(variants.size() * field.value().size());
+		for (const auto& variant : variants) {
+			for (const auto& value : field.value()) {
+				inja::json next = variant;
+				next[field.key()] = value;
+				expanded.push_back(std::move(next));
+			}
+		}
+		variants = std::move(expanded);
+	}
+
+	return variants;
+}
+
+BatchResult generateBatch(TemplateLoader& templateLoader, const std::vector<std::unique_ptr<Node>>& nodes,
+	const std::vector<inja::json>& variants, const std::string& outputDirectory) {
+	struct Job {
+		size_t variant;
+		const PipelineNode* pipeline;
+		std::string fileName;
+	};
+
+	std::vector<const PipelineNode*> pipelines;
+	for (const auto& node : nodes) {
+		if (auto pipelineNode = dynamic_cast<const PipelineNode*>(node.get())) {
+			pipelines.push_back(pipelineNode);
+		}
+	}
+
+	std::vector<Job> jobs;
+	inja::json manifest = inja::json::array();
+	for (size_t variant = 0; variant < variants.size(); variant++) {
+		for (const PipelineNode* pipeline : pipelines) {
+			std::string fileName = "renderer_" + std::to_string(variant);
+			if (pipelines.size() > 1) fileName += "_" + std::to_string(pipeline->getId());
+			fileName += ".cpp";
+
+			jobs.push_back({ variant, pipeline, fileName });
+			manifest.push_back({ { "file", fileName }, { "pipeline", pipeline->getId() }, { "settings", variants[variant] } });
+		}
+	}
+
+	std::filesystem::create_directories(outputDirectory);
+
+	// Variants already keep every core busy, nested fragment tasks would only add threads
+	bool parallel = templateLoader.parallel;
+	templateLoader.parallel = false;
+
+	std::atomic<size_t> nextJob = 0;
+	std::atomic<size_t> written = 0;
+	std::atomic<size_t> failed = 0;
+	auto worker = [&] {
+		for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+			const Job& job = jobs[i];
+			try {
+				// A node per variant, generation fills in the node's template data
+				PipelineNode variantNode{ job.pipeline->getId() };
+				variantNode.copyInputsFrom(*job.pipeline);
+
+				PipelineSettings settings = job.pipeline->settings.value();
+				variants[job.variant].get_to(settings);
+
+				FragmentPtr renderer = variantNode.generateFragment(templateLoader, settings);
+				if (renderer && renderer->writeToFile((std::filesystem::path(outputDirectory) / job.fileName).string())) {
+					written++;
+				} else {
+					failed++;
+				}
+			} catch (const std::exception& e) {
+				std::cerr << job.fileName << ": " << e.what() << "\n";
+				failed++;
+			}
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int i = 0; i < workerCount; i++) {
+		workers.emplace_back(worker);
+	}
+	for (std::thread& thread : workers) {
+		thread.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	templateLoader.parallel = parallel;
+
+	std::ofstream manifestFile(std::filesystem::path(outputDirectory) / "variants.json", std::ios::trunc);
+	manifestFile << manifest.dump(4) << "\n";
+
+	return { written.load(), failed.load(), std::chrono::duration<double>(end - start).count() };
+}
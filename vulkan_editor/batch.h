@@ -0,0 +1,19 @@
+#pragma once
+
+#include "pipeline.h"
+#include <memory>
+
+struct BatchResult {
+	size_t written = 0;
+	size_t failed = 0;
+	double seconds = 0.0;
+};
+
+// spec maps PipelineSettings fields to arrays of values, every combination of them is one variant.
+// A variant holds only the fields it overrides.
+std::vector<inja::json> expandPermutations(const inja::json& spec);
+
+// Writes one file per variant and pipeline of the graph into outputDirectory,
+// plus variants.json listing the settings each file was generated with.
+BatchResult generateBatch(TemplateLoader& templateLoader, const std::vector<std::unique_ptr<Node>>& nodes,
+	const std::vector<inja::json>& variants, const std::string& outputDirectory);
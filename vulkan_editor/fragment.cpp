@@ -0,0 +1,121 @@
+#include "fragment.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+static constexpr char placeholderMark = '\x1F';
+
+// Compares everything written to it with the bytes of an existing file, so output is checked without being kept in memory
+class ComparingBuffer : public std::streambuf {
+public:
+	explicit ComparingBuffer(std::string existing) : existing(std::move(existing)) {}
+
+	bool matches() const { return same && position == existing.size(); }
+
+protected:
+	std::streamsize xsputn(const char* data, std::streamsize count) override {
+		size_t length = static_cast<size_t>(count);
+		if (same && (position + length > existing.size() || existing.compare(position, length, data, length) != 0)) {
+			same = false;
+		}
+		position += length;
+		return count;
+	}
+
+	int_type overflow(int_type ch) override {
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			char c = traits_type::to_char_type(ch);
+			xsputn(&c, 1);
+		}
+		return ch;
+	}
+
+private:
+	std::string existing;
+	size_t position = 0;
+	bool same = true;
+};
+
+Fragment::Fragment(std::shared_ptr<const std::string> text, std::map<std::string, FragmentPtr> children)
+	: text(std::move(text)), children(std::move(children)) {}
+
+FragmentPtr Fragment::fromText(std::string text, std::map<std::string, FragmentPtr> children) {
+	return std::make_shared<Fragment>(std::make_shared<const std::string>(std::move(text)), std::move(children));
+}
+
+std::string Fragment::placeholder(const std::string& name) {
+	return placeholderMark + name + placeholderMark;
+}
+
+FragmentPtr Fragment::withChildren(std::map<std::string, FragmentPtr> children) const {
+	return std::make_shared<Fragment>(text, std::move(children));
+}
+
+void Fragment::writeTo(std::ostream& out) const {
+	size_t position = 0;
+	while (position < text->size()) {
+		size_t start = text->find(placeholderMark, position);
+		size_t end = start == std::string::npos ? std::string::npos : text->find(placeholderMark, start + 1);
+		if (end == std::string::npos) {
+			out.write(text->data() + position, text->size() - position);
+			return;
+		}
+
+		out.write(text->data() + position, start - position);
+		auto child = children.find(text->substr(start + 1, end - start - 1));
+		if (child != children.end()) {
+			child->second->writeTo(out);
+		} else {
+			out.write(text->data() + start, end + 1 - start);
+		}
+		position = end + 1;
+	}
+}
+
+bool Fragment::writeToFile(const std::string& fileName) const {
+	// An identical file is left alone, a new mtime would make downstream builds recompile it
+	std::error_code error;
+	if (std::filesystem::exists(fileName, error)) {
+		std::ifstream inFile(fileName, std::ios::binary);
+		std::stringstream existing;
+		existing << inFile.rdbuf();
+
+		ComparingBuffer comparison(existing.str());
+		std::ostream comparer(&comparison);
+		writeTo(comparer);
+		if (inFile && comparison.matches()) return true;
+	}
+
+	// Written next to the target and renamed over it, readers never see a partial file
+	std::string tempFileName = fileName + ".tmp" + std::to_string(std::random_device{}());
+	{
+		std::ofstream outFile(tempFileName, std::ios::trunc | std::ios::binary);
+		if (!outFile.is_open()) {
+			std::cerr << "Error opening " << tempFileName << " for writing.\n";
+			return false;
+		}
+		writeTo(outFile);
+		outFile.close();
+		if (!outFile) {
+			std::cerr << "Error writing " << tempFileName << "\n";
+			std::filesystem::remove(tempFileName, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempFileName, fileName, error);
+	if (error) {
+		std::cerr << "Error replacing " << fileName << ": " << error.message() << "\n";
+		std::filesystem::remove(tempFileName, error);
+		return false;
+	}
+	return true;
+}
+
+std::string Fragment::str() const {
+	std::ostringstream out;
+	writeTo(out);
+	return out.str();
+}
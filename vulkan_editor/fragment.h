@@ -0,0 +1,32 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+
+class Fragment;
+using FragmentPtr = std::shared_ptr<const Fragment>;
+
+// Rendered template output. Nested fragments are not copied into the parent text,
+// the parent only holds a placeholder for each and they are joined while writing out.
+class Fragment {
+public:
+	Fragment(std::shared_ptr<const std::string> text, std::map<std::string, FragmentPtr> children = {});
+
+	static FragmentPtr fromText(std::string text, std::map<std::string, FragmentPtr> children = {});
+	// Value to put into the template data where the child called name goes
+	static std::string placeholder(const std::string& name);
+
+	// Same text with its children attached, for fragments rendered before their children were done
+	FragmentPtr withChildren(std::map<std::string, FragmentPtr> children) const;
+
+	void writeTo(std::ostream& out) const;
+	// Skips the write when the file already has this content, otherwise replaces it atomically
+	bool writeToFile(const std::string& fileName) const;
+	std::string str() const;
+
+private:
+	std::shared_ptr<const std::string> text;
+	std::map<std::string, FragmentPtr> children;
+};
@@ -0,0 +1,142 @@
+#include "graph.h"
+#include <fstream>
+
+namespace ed = ax::NodeEditor;
+
+bool connectLink(std::vector<std::unique_ptr<Node>>& nodes, std::vector<Link>& links, const Link& link) {
+    Node* startNode = nullptr;
+    Node* endNode = nullptr;
+    PinType startPinType = PinType::Unknown, endPinType = PinType::Unknown;
+
+    for (const auto& node : nodes) {
+        for (const auto& pin : node->outputPins) {
+            if (pin.id == link.startPin) {
+                startNode = node.get();
+                startPinType = pin.type;
+            }
+        }
+        for (const auto& pin : node->inputPins) {
+            if (pin.id == link.endPin) {
+                endNode = node.get();
+                endPinType = pin.type;
+            }
+        }
+    }
+
+    if (!startNode || !endNode) return false;
+
+    startNode->addLink(link);
+    endNode->addLink(link);
+    links.push_back(link);
+
+    if (auto modelNode = dynamic_cast<ModelNode*>(startNode)) {
+        if (auto pipelineNode = dynamic_cast<PipelineNode*>(endNode)) {
+            pipelineNode->setModel(modelNode);
+            if (startPinType == PinType::VertexOutput && endPinType == PinType::VertexInput) {
+                pipelineNode->setVertexDataInput(modelNode);
+            }
+            if (startPinType == PinType::ColorOutput && endPinType == PinType::ColorInput) {
+                pipelineNode->setColorDataInput(modelNode);
+            }
+            if (startPinType == PinType::TextureOutput && endPinType == PinType::TextureInput) {
+                pipelineNode->setTextureDataInput(modelNode);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool saveGraph(const std::string& fileName, const std::vector<std::unique_ptr<Node>>& nodes, const std::vector<Link>& links) {
+    inja::json graph;
+    graph["nodes"] = inja::json::array();
+    graph["links"] = inja::json::array();
+
+    for (const auto& node : nodes) {
+        inja::json nodeData;
+        nodeData["id"] = node->getId();
+        if (auto pipelineNode = dynamic_cast<PipelineNode*>(node.get())) {
+            nodeData["type"] = "Pipeline";
+            nodeData["settings"] = pipelineNode->settings.value();
+        } else if (auto modelNode = dynamic_cast<ModelNode*>(node.get())) {
+            nodeData["type"] = "Model";
+            nodeData["settings"] = *modelNode;
+        } else {
+            continue;
+        }
+        graph["nodes"].push_back(nodeData);
+    }
+
+    for (const auto& link : links) {
+        graph["links"].push_back({
+            { "id", link.id },
+            { "startPin", link.startPin.Get() },
+            { "endPin", link.endPin.Get() }
+        });
+    }
+
+    std::ofstream outFile(fileName, std::ios::trunc);
+    if (!outFile.is_open()) {
+        std::cerr << "Error opening " << fileName << " for writing.\n";
+        return false;
+    }
+    outFile << graph.dump(4) << "\n";
+    return true;
+}
+
+bool loadGraph(const std::string& fileName, std::vector<std::unique_ptr<Node>>& nodes, std::vector<Link>& links, int& currentId) {
+    std::ifstream inFile(fileName);
+    if (!inFile.is_open()) {
+        std::cerr << "Error opening " << fileName << " for reading.\n";
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Node>> loadedNodes;
+    std::vector<Link> loadedLinks;
+    int maxId = 0;
+
+    try {
+        inja::json graph = inja::json::parse(inFile);
+
+        for (const auto& nodeData : graph.at("nodes")) {
+            int id = nodeData.at("id").get<int>();
+            std::string type = nodeData.at("type").get<std::string>();
+            inja::json settings = nodeData.value("settings", inja::json::object());
+
+            if (type == "Pipeline") {
+                auto pipelineNode = std::make_unique<PipelineNode>(id);
+                settings.get_to(pipelineNode->settings.value());
+                loadedNodes.emplace_back(std::move(pipelineNode));
+            } else if (type == "Model") {
+                auto modelNode = std::make_unique<ModelNode>(id);
+                settings.get_to(*modelNode);
+                loadedNodes.emplace_back(std::move(modelNode));
+            } else {
+                std::cerr << "Unknown node type " << type << " in " << fileName << "\n";
+                return false;
+            }
+            maxId = std::max(maxId, id);
+        }
+
+        for (const auto& linkData : graph.value("links", inja::json::array())) {
+            Link link;
+            link.id = linkData.at("id").get<int>();
+            link.startPin = ed::PinId(linkData.at("startPin").get<uintptr_t>());
+            link.endPin = ed::PinId(linkData.at("endPin").get<uintptr_t>());
+
+            if (!connectLink(loadedNodes, loadedLinks, link)) {
+                std::cerr << "Link " << link.id << " in " << fileName << " does not connect two nodes\n";
+                return false;
+            }
+            maxId = std::max(maxId, link.id);
+        }
+    } catch (const inja::json::exception& e) {
+        std::cerr << "Error reading graph " << fileName << ": " << e.what() << "\n";
+        return false;
+    }
+
+    nodes = std::move(loadedNodes);
+    links = std::move(loadedLinks);
+    currentId = maxId + 1;
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "pipeline.h"
+#include <memory>
+
+// Registers a link on both nodes it connects and wires the pipeline inputs it carries.
+bool connectLink(std::vector<std::unique_ptr<Node>>& nodes, std::vector<Link>& links, const Link& link);
+
+bool saveGraph(const std::string& fileName, const std::vector<std::unique_ptr<Node>>& nodes, const std::vector<Link>& links);
+bool loadGraph(const std::string& fileName, std::vector<std::unique_ptr<Node>>& nodes, std::vector<Link>& links, int& currentId);
@@ -1,9 +1,11 @@
 #include "header.h"
 
-std::string generateHeaders(TemplateLoader templateLoader) {
-	return templateLoader.renderTemplateFile("vulkan_templates/header.txt", data);
+FragmentPtr generateHeaders(TemplateLoader& templateLoader, bool splitOutput) {
+	inja::json headerData = data;
+	headerData["splitOutput"] = splitOutput;
+	return templateLoader.renderTemplateFile("vulkan_templates/header.txt", headerData);
 }
 
-std::string generateGlobalVariables(TemplateLoader templateLoader) {
+FragmentPtr generateGlobalVariables(TemplateLoader& templateLoader) {
 	return templateLoader.renderTemplateFile("vulkan_templates/globalVariables.txt", data);
 }
@@ -4,5 +4,5 @@
 
 static inja::json data;
 
-std::string generateHeaders(TemplateLoader templateLoader);
-std::string generateGlobalVariables(TemplateLoader templateLoader);
+FragmentPtr generateHeaders(TemplateLoader& templateLoader, bool splitOutput);
+FragmentPtr generateGlobalVariables(TemplateLoader& templateLoader);
@@ -6,10 +6,12 @@ InstanceNode::~InstanceNode() { }
 
 void InstanceNode::render() const {}
 
-std::string InstanceNode::generateInstance(TemplateLoader templateLoader) {
-	data["application"] = templateLoader.renderTemplateFile("vulkan_templates/application.txt", data);
-	data["utils"] = templateLoader.renderTemplateFile("vulkan_templates/utils.txt", data);
+FragmentPtr InstanceNode::generateInstance(TemplateLoader& templateLoader) {
+	data["application"] = Fragment::placeholder("application");
+	data["utils"] = Fragment::placeholder("utils");
 
-	std::cout << "Code was sucessfully generated in renderer.cpp\n";
-    return templateLoader.renderTemplateFile("vulkan_templates/instance.txt", data);
+    return templateLoader.renderTemplateFile("vulkan_templates/instance.txt", data, {
+        { "application", templateLoader.renderTemplateFile("vulkan_templates/application.txt", data) },
+        { "utils", templateLoader.renderTemplateFile("vulkan_templates/utils.txt", data) }
+    });
 }
@@ -11,7 +11,7 @@ public:
 
 	void render() const override;
 
-	std::string generateInstance(TemplateLoader templateLoader);
+	FragmentPtr generateInstance(TemplateLoader& templateLoader);
 private:
 	inja::json data;
 };
@@ -5,9 +5,10 @@ LogicalDeviceNode::~LogicalDeviceNode() { }
 
 void LogicalDeviceNode::render() const {}
 
-std::string LogicalDeviceNode::generateLogicalDevice(TemplateLoader templateLoader) {
+FragmentPtr LogicalDeviceNode::generateLogicalDevice(TemplateLoader& templateLoader) {
 	PhysicalDeviceNode physicalDevice{id};
-    data["physicalDevice"] = physicalDevice.generatePhysicalDevice(templateLoader);
+    data["physicalDevice"] = Fragment::placeholder("physicalDevice");
 
-    return templateLoader.renderTemplateFile("vulkan_templates/logicalDevice.txt", data);
+    return templateLoader.renderTemplateFile("vulkan_templates/logicalDevice.txt", data,
+        { { "physicalDevice", physicalDevice.generatePhysicalDevice(templateLoader) } });
 }
@@ -9,7 +9,7 @@ public:
 
 	void render() const override;
 
-	std::string generateLogicalDevice(TemplateLoader templateLoader);
+	FragmentPtr generateLogicalDevice(TemplateLoader& templateLoader);
 private:
 	inja::json data;
 };
@@ -0,0 +1,214 @@
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "mesh.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+struct VertexEqual {
+    bool operator()(const MeshVertex& a, const MeshVertex& b) const {
+        return a.pos[0] == b.pos[0] && a.pos[1] == b.pos[1] && a.pos[2] == b.pos[2] &&
+               a.color[0] == b.color[0] && a.color[1] == b.color[1] && a.color[2] == b.color[2] &&
+               a.texCoord[0] == b.texCoord[0] && a.texCoord[1] == b.texCoord[1];
+    }
+};
+
+// Mirrors the std::hash<Vertex> the generated renderer declares, the weak hash the default loader uses
+size_t hashVec2(const float* vec) {
+    return (std::hash<float>()(vec[0]) ^ (std::hash<float>()(vec[1]) << 1)) >> 1;
+}
+
+size_t hashVec3(const float* vec) {
+    return ((std::hash<float>()(vec[0]) ^ (std::hash<float>()(vec[1]) << 1)) >> 1) ^ (std::hash<float>()(vec[2]) << 1);
+}
+
+struct WeakVertexHash {
+    size_t operator()(const MeshVertex& vertex) const {
+        return ((hashVec3(vertex.pos) ^ (hashVec3(vertex.color) << 1)) >> 1) ^ (hashVec2(vertex.texCoord) << 1);
+    }
+};
+
+// Corners without a texcoord have texcoord_index -1 and keep a zero texCoord, as in gve::loadObjParallel
+MeshVertex makeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index) {
+    const float* texcoord = index.texcoord_index >= 0 ? &attrib.texcoords[2 * index.texcoord_index] : nullptr;
+    return gve::makeObjVertex<MeshVertex>(&attrib.vertices[3 * index.vertex_index], texcoord);
+}
+
+}
+
+bool parseObj(const std::string& fileName, ObjData& obj) {
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&obj.attrib, &obj.shapes, &materials, &warn, &err, fileName.c_str())) {
+        std::cerr << "Error loading " << fileName << ": " << warn << err << "\n";
+        return false;
+    }
+    return true;
+}
+
+size_t objIndexCount(const ObjData& obj) {
+    size_t indexCount = 0;
+    for (const auto& shape : obj.shapes) indexCount += shape.mesh.indices.size();
+    return indexCount;
+}
+
+void dedupVertices(const ObjData& obj, VertexDedup dedup, MeshData& mesh) {
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    if (dedup == VertexDedup::HashMap) {
+        std::unordered_map<MeshVertex, uint32_t, WeakVertexHash, VertexEqual> uniqueVertices{};
+        for (const auto& shape : obj.shapes) {
+            for (const auto& index : shape.mesh.indices) {
+                MeshVertex vertex = makeVertex(obj.attrib, index);
+                if (uniqueVertices.count(vertex) == 0) {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(mesh.vertices.size());
+                    mesh.vertices.push_back(vertex);
+                }
+                mesh.indices.push_back(uniqueVertices[vertex]);
+            }
+        }
+        return;
+    }
+
+    size_t indexCount = objIndexCount(obj);
+    mesh.indices.reserve(indexCount);
+    gve::VertexDedupMap<MeshVertex> uniqueVertices{indexCount};
+    for (const auto& shape : obj.shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            mesh.indices.push_back(uniqueVertices.findOrInsert(makeVertex(obj.attrib, index), mesh.vertices));
+        }
+    }
+}
+
+ObjData makeGridObj(size_t gridSize) {
+    ObjData obj;
+    size_t side = gridSize + 1;
+    obj.attrib.vertices.reserve(side * side * 3);
+    obj.attrib.texcoords.reserve(side * side * 2);
+    for (size_t y = 0; y < side; y++) {
+        for (size_t x = 0; x < side; x++) {
+            float u = static_cast<float>(x) / gridSize;
+            float v = static_cast<float>(y) / gridSize;
+            obj.attrib.vertices.insert(obj.attrib.vertices.end(), { u, v, 0.0f });
+            obj.attrib.texcoords.insert(obj.attrib.texcoords.end(), { u, v });
+        }
+    }
+
+    tinyobj::shape_t shape;
+    shape.name = "grid";
+    shape.mesh.indices.reserve(gridSize * gridSize * 6);
+    auto corner = [side](size_t x, size_t y) {
+        int i = static_cast<int>(y * side + x);
+        return tinyobj::index_t{ i, -1, i };
+    };
+    for (size_t y = 0; y < gridSize; y++) {
+        for (size_t x = 0; x < gridSize; x++) {
+            shape.mesh.indices.insert(shape.mesh.indices.end(), {
+                corner(x, y), corner(x + 1, y), corner(x + 1, y + 1),
+                corner(x, y), corner(x + 1, y + 1), corner(x, y + 1)
+            });
+        }
+    }
+    shape.mesh.num_face_vertices.assign(gridSize * gridSize * 2, 3);
+    obj.shapes.push_back(std::move(shape));
+    return obj;
+}
+
+bool loadObjParallel(const std::string& fileName, unsigned threadCount, MeshData& mesh) {
+    try {
+        gve::loadObjParallel(fileName, threadCount, mesh.vertices, mesh.indices);
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading " << fileName << ": " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool writeObj(const ObjData& obj, const std::string& fileName) {
+    std::ofstream file(fileName);
+    if (!file.is_open()) {
+        std::cerr << "Error opening " << fileName << " for writing.\n";
+        return false;
+    }
+
+    const auto& attrib = obj.attrib;
+    for (size_t i = 0; i + 2 < attrib.vertices.size(); i += 3) {
+        file << "v " << attrib.vertices[i] << " " << attrib.vertices[i + 1] << " " << attrib.vertices[i + 2] << "\n";
+    }
+    for (size_t i = 0; i + 1 < attrib.texcoords.size(); i += 2) {
+        file << "vt " << attrib.texcoords[i] << " " << attrib.texcoords[i + 1] << "\n";
+    }
+    for (const auto& shape : obj.shapes) {
+        file << "o " << shape.name << "\n";
+        size_t offset = 0;
+        for (auto faceVertices : shape.mesh.num_face_vertices) {
+            file << "f";
+            for (size_t i = 0; i < faceVertices; i++) {
+                const tinyobj::index_t& index = shape.mesh.indices[offset + i];
+                file << " " << index.vertex_index + 1;
+                if (index.texcoord_index >= 0) file << "/" << index.texcoord_index + 1;
+            }
+            file << "\n";
+            offset += faceVertices;
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool cookMesh(const std::string& modelPath, bool optimize) {
+    uint32_t flags = optimize ? gve::cookedMeshOptimized : 0;
+    gve::CookedMeshHeader header{};
+    bool current = false;
+    {
+        std::ifstream cookedFile;
+        current = gve::openCookedMesh<MeshVertex>(modelPath, flags, cookedFile, header);
+    }
+
+    // A cooked mesh that only matched by hash is written again with the OBJ's new time, so renderer loads skip the hash
+    MeshData mesh;
+    if (current) {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        if (gve::sourceStat(modelPath, sourceSize, sourceTime) && sourceTime == header.sourceTime) return true;
+        if (!loadCookedMesh(modelPath, optimize, mesh)) return false;
+    } else {
+        ObjData obj;
+        if (!parseObj(modelPath, obj)) return false;
+        dedupVertices(obj, VertexDedup::FlatMap, mesh);
+        if (optimize) optimizeMesh(mesh);
+    }
+
+    if (!gve::writeCookedMesh(modelPath, flags, mesh.vertices, mesh.indices)) {
+        std::cerr << "Error writing " << gve::cookedMeshPath(modelPath) << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool loadCookedMesh(const std::string& modelPath, bool optimize, MeshData& mesh) {
+    return gve::loadCookedMesh(modelPath, optimize ? gve::cookedMeshOptimized : 0, mesh.vertices, mesh.indices);
+}
+
+void optimizeMesh(MeshData& mesh) {
+    gve::optimizeMesh(mesh.vertices, mesh.indices);
+}
+
+double averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize) {
+    if (indices.size() < 3) return 0.0;
+
+    // Timestamps stand in for the FIFO: a vertex is cached while fewer than cacheSize misses came after its own
+    std::vector<size_t> missedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (missedAt[index] == 0 || misses - missedAt[index] >= cacheSize) {
+            misses++;
+            missedAt[index] = misses;
+        }
+    }
+    return double(misses) / (indices.size() / 3);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "../libs/tiny_obj_loader.h"
+#include "../vulkan_templates/meshLoader.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Same layout as the Vertex struct of the generated renderer, without the glm dependency
+struct MeshVertex {
+    float pos[3];
+    float color[3];
+    float texCoord[2];
+};
+
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// OBJ file as tinyobj returns it, before the vertices are deduplicated
+struct ObjData {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+};
+
+enum class VertexDedup {
+    HashMap,    // std::unordered_map with the generated std::hash<Vertex>, the default loader
+    FlatMap     // gve::VertexDedupMap, the fastVertexDedup loader
+};
+
+bool parseObj(const std::string& fileName, ObjData& obj);
+
+// Builds the index buffer the way the generated loadModel does, with either map
+void dedupVertices(const ObjData& obj, VertexDedup dedup, MeshData& mesh);
+
+// Grid of gridSize x gridSize quads with shared corners, for meshes larger than the sample models
+ObjData makeGridObj(size_t gridSize);
+
+size_t objIndexCount(const ObjData& obj);
+
+// gve::loadObjParallel, the parallelLoading loader, with threadCount threads.
+// The result matches parseObj followed by dedupVertices.
+bool loadObjParallel(const std::string& fileName, unsigned threadCount, MeshData& mesh);
+
+bool writeObj(const ObjData& obj, const std::string& fileName);
+
+// Cooks modelPath with gve::writeCookedMesh unless an up to date cooked mesh exists, optimized with optimizeMesh if optimize is set.
+// One that only matches the OBJ by hash is rewritten with the OBJ's current time, the renderer never writes it.
+bool cookMesh(const std::string& modelPath, bool optimize);
+
+// gve::loadCookedMesh, false when the cooked mesh is missing, stale or cooked with other flags
+bool loadCookedMesh(const std::string& modelPath, bool optimize, MeshData& mesh);
+
+// gve::optimizeMesh, the optimizeMesh stage of the generated loader
+void optimizeMesh(MeshData& mesh);
+
+// Average cache miss ratio, vertex shader invocations per triangle with a FIFO cache of cacheSize vertices
+double averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize);
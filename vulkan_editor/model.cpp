@@ -2,52 +2,86 @@
 
 namespace ed = ax::NodeEditor;
 
+std::vector<const char*> positionFormats = { "float32", "float16", "snorm16" };
+std::vector<const char*> colorFormats = { "float32", "unorm8", "none" };
+std::vector<const char*> texCoordFormats = { "float32", "unorm16" };
+
+static const std::vector<std::string> positionAttributeFormats = { "VK_FORMAT_R32G32B32_SFLOAT", "VK_FORMAT_R16G16B16A16_SFLOAT", "VK_FORMAT_R16G16B16A16_SNORM" };
+static const std::vector<std::string> positionMemberTypes = { "glm::vec3", "glm::u16vec4", "glm::i16vec4" };
+static const std::vector<std::string> colorAttributeFormats = { "VK_FORMAT_R32G32B32_SFLOAT", "VK_FORMAT_R8G8B8A8_UNORM" };
+static const std::vector<std::string> colorMemberTypes = { "glm::vec3", "glm::u8vec4" };
+static const std::vector<std::string> texCoordAttributeFormats = { "VK_FORMAT_R32G32_SFLOAT", "VK_FORMAT_R16G16_UNORM" };
+static const std::vector<std::string> texCoordMemberTypes = { "glm::vec2", "glm::u16vec2" };
+static constexpr int colorDropped = 2;
+
 ModelNode::ModelNode(int id) : Node(id) {
  	outputPins.push_back({ ed::PinId(id * 10 + 1), PinType::VertexOutput });
   	outputPins.push_back({ ed::PinId(id * 10 + 2), PinType::ColorOutput });
     outputPins.push_back({ ed::PinId(id * 10 + 3), PinType::TextureOutput });
     attributesCount = outputPins.size();
-
-    data["modelPath"] = modelPath;
-    data["texturePath"] = texturePath;
 }
 
 ModelNode::~ModelNode() { }
 
-std::string ModelNode::generateVertexBindings(std::ofstream& outFile) {
-	std::string result = "";
+bool ModelNode::packedVertices() const {
+    return positionFormat != 0 || colorFormat != 0 || texCoordFormat != 0;
+}
 
-    result += "        attributeDescriptions[0].binding = 0;\n";
-    result += "        attributeDescriptions[0].location = 0;\n";
-    result += "        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;\n";
-    result += "        attributeDescriptions[0].offset = offsetof(Vertex, pos);\n\n";
+bool ModelNode::dropsColor() const {
+    return colorFormat == colorDropped;
+}
 
-    return result;
+std::vector<uint32_t> ModelNode::attributeLocations() const {
+    if (dropsColor()) return { 0, 2 };
+    return { 0, 1, 2 };
 }
 
-std::string ModelNode::generateColorBindings(std::ofstream& outFile) {
-	std::string result = "";
-    result += "        attributeDescriptions[1].binding = 0;\n";
-    result += "        attributeDescriptions[1].location = 1;\n";
-    result += "        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;\n";
-    result += "        attributeDescriptions[1].offset = offsetof(Vertex, color);\n\n";
+bool ModelNode::usesMeshLoader() const {
+    return fastVertexDedup || parallelLoading || cookedMesh || optimizeMesh;
+}
 
-    return result;
+bool ModelNode::usesSharedObjectData() const {
+    return sharedObjectData || bindlessTextures;
 }
 
-std::string ModelNode::generateTextureBindings(std::ofstream& outFile) {
-	std::string result = "";
-	result += "        attributeDescriptions[2].binding = 0;\n";
-	result += "        attributeDescriptions[2].location = 2;\n";
-	result += "        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;\n";
-    result += "        attributeDescriptions[2].offset = offsetof(Vertex, texCoord);\n\n";
+void ModelNode::generateVertexBindings(std::string& out) {
+    std::string vertexType = packedVertices() ? "PackedVertex" : "Vertex";
+    out += "        attributeDescriptions[0].binding = 0;\n";
+    out += "        attributeDescriptions[0].location = 0;\n";
+    out += "        attributeDescriptions[0].format = " + positionAttributeFormats.at(positionFormat) + ";\n";
+    out += "        attributeDescriptions[0].offset = offsetof(" + vertexType + ", pos);\n\n";
+}
 
-    return result;
+// A dropped color leaves location 1 unfed, the _nocolor vertex shaders do not read it
+void ModelNode::generateColorBindings(std::string& out) {
+    if (dropsColor()) return;
+    std::string vertexType = packedVertices() ? "PackedVertex" : "Vertex";
+    out += "        attributeDescriptions[1].binding = 0;\n";
+    out += "        attributeDescriptions[1].location = 1;\n";
+    out += "        attributeDescriptions[1].format = " + colorAttributeFormats.at(colorFormat) + ";\n";
+    out += "        attributeDescriptions[1].offset = offsetof(" + vertexType + ", color);\n\n";
 }
 
-std::string ModelNode::generateVertexStructFilePart1(std::ofstream& outFile) {
-	std::string result = "";
-    result +=  R"(
+void ModelNode::generateTextureBindings(std::string& out) {
+    std::string vertexType = packedVertices() ? "PackedVertex" : "Vertex";
+    std::string index = dropsColor() ? "1" : "2";
+	out += "        attributeDescriptions[" + index + "].binding = 0;\n";
+	out += "        attributeDescriptions[" + index + "].location = 2;\n";
+	out += "        attributeDescriptions[" + index + "].format = " + texCoordAttributeFormats.at(texCoordFormat) + ";\n";
+    out += "        attributeDescriptions[" + index + "].offset = offsetof(" + vertexType + ", texCoord);\n\n";
+}
+
+void ModelNode::generateVertexStructFilePart1(std::string& out) {
+    // The loader deduplicates and cooks full precision vertices, the buffer gets this layout
+    if (packedVertices()) {
+        out += "\nstruct PackedVertex {\n";
+        out += "    " + positionMemberTypes.at(positionFormat) + " pos;\n";
+        if (!dropsColor()) out += "    " + colorMemberTypes.at(colorFormat) + " color;\n";
+        out += "    " + texCoordMemberTypes.at(texCoordFormat) + " texCoord;\n";
+        out += "};\n";
+    }
+
+    out +=  R"(
 struct Vertex {
 	glm::vec3 pos;
     glm::vec3 color;
@@ -56,7 +90,7 @@ struct Vertex {
     static VkVertexInputBindingDescription getBindingDescription() {
     	VkVertexInputBindingDescription bindingDescription{};
         bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
+        bindingDescription.stride = sizeof()" + std::string(packedVertices() ? "PackedVertex" : "Vertex") + R"();
         bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
         return bindingDescription;
@@ -64,23 +98,21 @@ struct Vertex {
 
     static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
 )";
-    result += "        std::vector<VkVertexInputAttributeDescription>attributeDescriptions(" + std::to_string(attributesCount);
-   result += ");\n\n";
-
-   return result;
+    size_t count = dropsColor() ? attributesCount - 1 : attributesCount;
+    out += "        std::vector<VkVertexInputAttributeDescription>attributeDescriptions(" + std::to_string(count);
+   out += ");\n\n";
 }
 
-std::string ModelNode::generateVertexStructFilePart2(std::ofstream& outFile) {
-	std::string result = "";
-    result += "        return attributeDescriptions;\n";
-    result += "    }\n\n";
+void ModelNode::generateVertexStructFilePart2(std::string& out) {
+    out += "        return attributeDescriptions;\n";
+    out += "    }\n\n";
 
-    result += "    bool operator==(const Vertex& other) const {\n";
-    result += "        return pos == other.pos && color == other.color && texCoord == other.texCoord;\n";
-    result += "    }\n";
-    result += "};\n\n";
+    out += "    bool operator==(const Vertex& other) const {\n";
+    out += "        return pos == other.pos && color == other.color && texCoord == other.texCoord;\n";
+    out += "    }\n";
+    out += "};\n\n";
 
-    result += R"(
+    out += R"(
 namespace std {
     template<> struct hash<glm::vec2> {
         size_t operator()(glm::vec2 const& vec) const {
@@ -102,21 +134,54 @@ namespace std {
     };
 }
 )";
-    return result;
 }
 
-std::string ModelNode::generateModel(TemplateLoader templateLoader) {
-    RenderPassNode renderpass{id};
-
-    data["buffer"] = templateLoader.renderTemplateFile("vulkan_templates/buffer.txt", data);
-    data["image"] = templateLoader.renderTemplateFile("vulkan_templates/image.txt", data);
-
-    data["renderpass"] = renderpass.generateRenderpass(templateLoader);
-
-    return templateLoader.renderTemplateFile("vulkan_templates/model.txt", data);
+FragmentPtr ModelNode::generateModel(TemplateLoader& templateLoader) const {
+    // Local data and a local renderpass so pipelines sharing this model can generate at the same time
+    inja::json data;
+    data["modelPath"] = modelPath;
+    data["texturePath"] = texturePath;
+    data["fastVertexDedup"] = fastVertexDedup;
+    data["parallelLoading"] = parallelLoading;
+    data["cookedMesh"] = cookedMesh;
+    data["optimizeMesh"] = optimizeMesh;
+    data["shortIndices"] = shortIndices;
+    data["geometryArena"] = geometryArena;
+    data["batchedUploads"] = batchedUploads;
+    data["generateMipmaps"] = generateMipmaps;
+    data["compressedTextures"] = compressedTextures;
+    data["asyncLoading"] = asyncLoading;
+    data["mappedTextures"] = mappedTextures;
+    data["textureCache"] = textureCache;
+    data["bindlessTextures"] = bindlessTextures;
+    data["sharedObjectData"] = usesSharedObjectData();
+    data["cookedMeshFlags"] = optimizeMesh ? "gve::cookedMeshOptimized" : "0";
+    data["packedVertices"] = packedVertices();
+    data["positionFormat"] = positionFormats.at(positionFormat);
+    data["colorFormat"] = colorFormats.at(colorFormat);
+    data["texCoordFormat"] = texCoordFormats.at(texCoordFormat);
+
+    // The renderpass chain renders five templates, buffer and image are left to this thread
+    FragmentTask renderpass = templateLoader.spawn([&templateLoader, id = id] {
+        RenderPassNode renderpass{id};
+        return renderpass.generateRenderpass(templateLoader);
+    });
+    FragmentPtr buffer = templateLoader.renderTemplateFile("vulkan_templates/buffer.txt", data);
+    FragmentPtr image = templateLoader.renderTemplateFile("vulkan_templates/image.txt", data);
+
+    data["buffer"] = Fragment::placeholder("buffer");
+    data["image"] = Fragment::placeholder("image");
+    data["renderpass"] = Fragment::placeholder("renderpass");
+
+    return templateLoader.renderTemplateFile("vulkan_templates/model.txt", data)->withChildren({
+        { "buffer", buffer },
+        { "image", image },
+        { "renderpass", renderpass.get() }
+    });
 }
 
 void ModelNode::render() const {
+#ifndef GVE_HEADLESS
 	ed::BeginNode(this->id);
 	ImGui::Text("Model");
 
@@ -138,4 +203,49 @@ void ModelNode::render() const {
 	for (auto& link : links) {
       	ed::Link(link.id, link.startPin, link.endPin);
     }
+#endif
+}
+
+void to_json(inja::json& j, const ModelNode& node) {
+    j["modelPath"] = node.modelPath;
+    j["texturePath"] = node.texturePath;
+    j["fastVertexDedup"] = node.fastVertexDedup;
+    j["parallelLoading"] = node.parallelLoading;
+    j["cookedMesh"] = node.cookedMesh;
+    j["optimizeMesh"] = node.optimizeMesh;
+    j["shortIndices"] = node.shortIndices;
+    j["geometryArena"] = node.geometryArena;
+    j["batchedUploads"] = node.batchedUploads;
+    j["generateMipmaps"] = node.generateMipmaps;
+    j["compressedTextures"] = node.compressedTextures;
+    j["asyncLoading"] = node.asyncLoading;
+    j["mappedTextures"] = node.mappedTextures;
+    j["textureCache"] = node.textureCache;
+    j["bindlessTextures"] = node.bindlessTextures;
+    j["sharedObjectData"] = node.sharedObjectData;
+    j["positionFormat"] = node.positionFormat;
+    j["colorFormat"] = node.colorFormat;
+    j["texCoordFormat"] = node.texCoordFormat;
+}
+
+void from_json(const inja::json& j, ModelNode& node) {
+    copyString(node.modelPath, j.value("modelPath", std::string(node.modelPath)));
+    copyString(node.texturePath, j.value("texturePath", std::string(node.texturePath)));
+    node.fastVertexDedup = j.value("fastVertexDedup", node.fastVertexDedup);
+    node.parallelLoading = j.value("parallelLoading", node.parallelLoading);
+    node.cookedMesh = j.value("cookedMesh", node.cookedMesh);
+    node.optimizeMesh = j.value("optimizeMesh", node.optimizeMesh);
+    node.shortIndices = j.value("shortIndices", node.shortIndices);
+    node.geometryArena = j.value("geometryArena", node.geometryArena);
+    node.batchedUploads = j.value("batchedUploads", node.batchedUploads);
+    node.generateMipmaps = j.value("generateMipmaps", node.generateMipmaps);
+    node.compressedTextures = j.value("compressedTextures", node.compressedTextures);
+    node.asyncLoading = j.value("asyncLoading", node.asyncLoading);
+    node.mappedTextures = j.value("mappedTextures", node.mappedTextures);
+    node.textureCache = j.value("textureCache", node.textureCache);
+    node.bindlessTextures = j.value("bindlessTextures", node.bindlessTextures);
+    node.sharedObjectData = j.value("sharedObjectData", node.sharedObjectData);
+    node.positionFormat = j.value("positionFormat", node.positionFormat);
+    node.colorFormat = j.value("colorFormat", node.colorFormat);
+    node.texCoordFormat = j.value("texCoordFormat", node.texCoordFormat);
 }
@@ -1,19 +1,23 @@
 #pragma once
 #include "renderpass.h"
 
+extern std::vector<const char*> positionFormats;
+extern std::vector<const char*> colorFormats;
+extern std::vector<const char*> texCoordFormats;
+
 class VertexDataNode {
 public:
-    virtual std::string generateVertexBindings(std::ofstream& outFile) = 0;
+    virtual void generateVertexBindings(std::string& out) = 0;
 };
 
 class ColorDataNode {
 public:
-    virtual std::string generateColorBindings(std::ofstream& outFile) = 0;
+    virtual void generateColorBindings(std::string& out) = 0;
 };
 
 class TextureDataNode {
 public:
-    virtual std::string generateTextureBindings(std::ofstream& outFile) = 0;
+    virtual void generateTextureBindings(std::string& out) = 0;
 };
 
 class ModelNode : public Node, public VertexDataNode, public ColorDataNode, public TextureDataNode {
@@ -21,21 +25,50 @@ public:
 	size_t attributesCount = 0;
 	char modelPath[256] = "data/models/viking_room.obj";
 	char texturePath[256] = "data/images/viking_room.png";
+	bool fastVertexDedup = false;   // flat hash map over the raw vertex bytes in loadModel
+	bool parallelLoading = false;   // loadModel parses and deduplicates line aligned chunks of the OBJ on all cores
+	bool cookedMesh = false;        // loadModel reads <model>.gvemesh and only parses the OBJ when it is stale
+	bool optimizeMesh = false;      // vertex cache, overdraw and vertex fetch ordering after loading
+	bool shortIndices = false;      // 16 bit index buffers for meshes with fewer than 65536 vertices
+	bool geometryArena = false;     // all objects in one vertex and one index buffer, bound once per frame
+	bool batchedUploads = false;    // staging ring and transfer queue, copies submitted once per frame without waiting
+	bool generateMipmaps = false;   // full mip chain for the texture, blitted on the GPU or filtered on the CPU
+	bool compressedTextures = false; // BC or ASTC blocks from <texture>.ktx2 or a KTX2/DDS texture, uploaded as they are
+	bool asyncLoading = false;      // meshes and textures load on worker threads, objects are drawn as a placeholder cube until then
+	bool mappedTextures = false;    // stb_image decodes from a memory mapping of the texture file instead of reading it through stdio
+	bool textureCache = false;      // objects with the same texture path share one image, samplers are shared by settings
+	bool bindlessTextures = false;  // one descriptor indexing array of all textures, objects select theirs with push constants
+	bool sharedObjectData = false;  // view and proj in one buffer per frame, model matrices of all objects in one storage buffer
+	// Vertex buffer formats, anything but float32 packs the loaded vertices into PackedVertex on upload
+	int positionFormat = 0;
+	int colorFormat = 0;
+	int texCoordFormat = 0;
 
     ModelNode(int id);
 
     ~ModelNode() override;
 
-    std::string generateVertexBindings(std::ofstream& outFile) override;
-    std::string generateColorBindings(std::ofstream& outFile) override;
-    std::string generateTextureBindings(std::ofstream& outFile) override;
+    void generateVertexBindings(std::string& out) override;
+    void generateColorBindings(std::string& out) override;
+    void generateTextureBindings(std::string& out) override;
+
+    void generateVertexStructFilePart1(std::string& out);
+    void generateVertexStructFilePart2(std::string& out);
 
-    std::string generateVertexStructFilePart1(std::ofstream& outFile);
-    std::string generateVertexStructFilePart2(std::ofstream& outFile);
+    FragmentPtr generateModel(TemplateLoader& templateLoader) const;
 
-    std::string generateModel(TemplateLoader templateLoader);
+    bool packedVertices() const;
+    // Color format "none": no color attribute, pipelines pick the vertex shader without one
+    bool dropsColor() const;
+    // Locations getAttributeDescriptions feeds, ascending
+    std::vector<uint32_t> attributeLocations() const;
+    // The loader options that call into vulkan_templates/meshLoader.h
+    bool usesMeshLoader() const;
+    // Bindless textures index the shared object buffer, so they turn it on as well
+    bool usesSharedObjectData() const;
 
     void render() const override;
-private:
-	inja::json data;
 };
+
+void to_json(inja::json& j, const ModelNode& node);
+void from_json(const inja::json& j, ModelNode& node);
@@ -1,6 +1,10 @@
+#pragma once
+
 #include "../imgui-node-editor/imgui_node_editor.h"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <string>
 #include <vector>
 
 struct Link {
@@ -53,3 +57,10 @@ public:
     std::vector<Pin> outputPins;
 	std::vector<Link> links;
 };
+
+// Copies into one of the fixed size path buffers the ImGui text inputs edit in place.
+template <size_t N>
+void copyString(char (&destination)[N], const std::string& source) {
+    strncpy(destination, source.c_str(), N - 1);
+    destination[N - 1] = '\0';
+}
@@ -6,9 +6,10 @@ PhysicalDeviceNode::~PhysicalDeviceNode() { }
 
 void PhysicalDeviceNode::render() const {}
 
-std::string PhysicalDeviceNode::generatePhysicalDevice(TemplateLoader templateLoader) {
+FragmentPtr PhysicalDeviceNode::generatePhysicalDevice(TemplateLoader& templateLoader) {
 	InstanceNode instance{id};
-    data["instance"] = instance.generateInstance(templateLoader);
+    data["instance"] = Fragment::placeholder("instance");
 
-    return templateLoader.renderTemplateFile("vulkan_templates/physicalDevice.txt", data);
+    return templateLoader.renderTemplateFile("vulkan_templates/physicalDevice.txt", data,
+        { { "instance", instance.generateInstance(templateLoader) } });
 }
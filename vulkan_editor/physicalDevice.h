@@ -8,7 +8,7 @@ public:
 	~PhysicalDeviceNode() override;
 
 	void render() const override;
-	std::string generatePhysicalDevice(TemplateLoader templateLoader);
+	FragmentPtr generatePhysicalDevice(TemplateLoader& templateLoader);
 private:
 	inja::json data;
 };
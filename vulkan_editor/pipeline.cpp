@@ -1,6 +1,11 @@
 #include "pipeline.h"
 #include "model.h"
 #include "header.h"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <vulkan/vulkan.h>
 #include <inja/inja.hpp>
@@ -26,6 +31,7 @@ PipelineNode::PipelineNode(int id) : Node(id) {
 PipelineNode::~PipelineNode() { }
 
 void PipelineNode::render() const {
+#ifndef GVE_HEADLESS
    	ed::BeginNode(this->id);
     ImGui::Text("Pipeline");
 
@@ -47,6 +53,7 @@ void PipelineNode::render() const {
 	for (auto& link : links) {
     	ed::Link(link.id, link.startPin, link.endPin);
    	}
+#endif
 }
 
 std::string getColorWriteMaskString(uint32_t mask) {
@@ -86,23 +93,23 @@ void PipelineNode::fillOutputData(const PipelineSettings& settings) {
     outputData["vertexEntryName"] = settings.vertexEntryName;
     outputData["fragmentEntryName"] = settings.fragmentEntryName;
 
-    outputData["topologyOption"] = topologyOptions[settings.inputAssembly];
+    outputData["topologyOption"] = topologyOptions.at(settings.inputAssembly);
     outputData["primitiveRestart"] = (settings.primitiveRestart ? "VK_TRUE" : "VK_FALSE");
 
     outputData["depthClamp"] = (settings.depthClamp ? "VK_TRUE" : "VK_FALSE");
     outputData["rasterizerDiscard"] = (settings.rasterizerDiscard ? "VK_TRUE" : "VK_FALSE");
-    outputData["polygonMode"] = polygonModes[settings.polygonMode];
+    outputData["polygonMode"] = polygonModes.at(settings.polygonMode);
     outputData["lineWidth"] = settings.lineWidth;
-    outputData["cullMode"] = cullModes[settings.cullMode];
-    outputData["frontFace"] = frontFaceOptions[settings.frontFace];
+    outputData["cullMode"] = cullModes.at(settings.cullMode);
+    outputData["frontFace"] = frontFaceOptions.at(settings.frontFace);
     outputData["depthBiasEnabled"] = (settings.depthBiasEnabled ? "VK_TRUE" : "VK_FALSE");
 
     outputData["sampleShading"] = (settings.sampleShading ? "VK_TRUE" : "VK_FALSE");
-    outputData["rasterizationSamples"] = sampleCountOptions[settings.rasterizationSamples];
+    outputData["rasterizationSamples"] = sampleCountOptions.at(settings.rasterizationSamples);
 
     outputData["depthTest"] = (settings.depthTest ? "VK_TRUE" : "VK_FALSE");
     outputData["depthWrite"] = (settings.depthWrite ? "VK_TRUE" : "VK_FALSE");
-    outputData["depthCompareOp"] = depthCompareOptions[settings.depthCompareOp];
+    outputData["depthCompareOp"] = depthCompareOptions.at(settings.depthCompareOp);
     outputData["depthBoundTest"] = (settings.depthBoundsTest ? "VK_TRUE" : "VK_FALSE");
     outputData["stencilTest"] = (settings.stencilTest ? "VK_TRUE" : "VK_FALSE");
 
@@ -110,46 +117,229 @@ void PipelineNode::fillOutputData(const PipelineSettings& settings) {
     outputData["blendEnable"] = (settings.colorBlend ? "VK_TRUE" : "VK_FALSE");
 
     outputData["logicOpEnable"] = (settings.logicOpEnable ? "VK_TRUE" : "VK_FALSE");
-    outputData["logicOp"] = logicOps[settings.logicOp];
+    outputData["logicOp"] = logicOps.at(settings.logicOp);
     outputData["attachmentCount"] = settings.attachmentCount;
     outputData["blendConstants"] = { settings.blendConstants[0], settings.blendConstants[1], settings.blendConstants[2], settings.blendConstants[3] };
 }
 
-void PipelineNode::generate(TemplateLoader templateLoader, const PipelineSettings& settings) {
+static void reportMissingShader(const std::string& shaderPath) {
+    std::cerr << shaderPath << " is missing or not SPIR-V, build it from " << shaderSourcePath(shaderPath) << " with compile.sh" << std::endl;
+}
+
+// The renderer only loads its shaders at run time, a missing module or one reading an attribute the model does not feed
+// would only fail there
+bool PipelineNode::checkVertexShader(const std::string& vertexShaderPath) const {
+    std::vector<uint32_t> locations;
+    if (!readVertexInputLocations(vertexShaderPath, locations)) {
+        reportMissingShader(vertexShaderPath);
+        return false;
+    }
+
+    std::vector<uint32_t> fed = model->attributeLocations();
+    for (uint32_t location : locations) {
+        if (!std::binary_search(fed.begin(), fed.end(), location)) {
+            std::cerr << vertexShaderPath << " reads vertex input location " << location << ", which the model does not feed" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+FragmentPtr PipelineNode::generateFragment(TemplateLoader& templateLoader, const PipelineSettings& settings, bool splitOutput) {
     if (!vertexData) {
         std::cerr << "No vertex data input set" << std::endl;
-        return;
+        return nullptr;
     }
 
     if (!colorData) {
     	std::cerr << "No color data input set" << std::endl;
-	    return;
+	    return nullptr;
     }
 
     if (!textureData) {
         std::cerr << "No texture data input set" << std::endl;
-        return;
+        return nullptr;
     }
 
-    outFile.open("renderer.cpp", std::ios::trunc);
-    if (!outFile.is_open()) {
-        std::cerr << "Error opening file for writing.\n";
-        return;
+    // The shared object data and bindless layouts and a dropped color attribute do not fit the default shaders,
+    // they are swapped for matching variants
+    std::string vertexShaderPath = settings.vertexShaderPath;
+    if (vertexShaderPath == "shaders/vert.spv") {
+        std::string variant = std::string(model->usesSharedObjectData() ? "_shared" : "") + (model->dropsColor() ? "_nocolor" : "");
+        vertexShaderPath = "shaders/vert" + variant + ".spv";
+    }
+    std::string fragmentShaderPath = settings.fragmentShaderPath;
+    if (model->bindlessTextures && fragmentShaderPath == "shaders/frag.spv") {
+        fragmentShaderPath = "shaders/frag_bindless.spv";
+    }
+    if (!checkVertexShader(vertexShaderPath)) return nullptr;
+    if (!isSpirvFile(fragmentShaderPath)) {
+        reportMissingShader(fragmentShaderPath);
+        return nullptr;
     }
 
-    std::string result = model->generateVertexStructFilePart1(outFile);
-    result += vertexData->generateVertexBindings(outFile);
-    result += colorData->generateColorBindings(outFile);
-    result += textureData->generateTextureBindings(outFile);
-    result += model->generateVertexStructFilePart2(outFile);
+    // Fragments only hold placeholders for their children, so none of them waits for another to render.
+    // The model and its device chain make up most of the templates and get their own task.
+    FragmentTask modelFragment = templateLoader.spawn([&templateLoader, model = model] { return model->generateModel(templateLoader); });
+    FragmentPtr headers = generateHeaders(templateLoader, splitOutput);
+    FragmentPtr globalVariables = generateGlobalVariables(templateLoader);
 
-    data["header"] = generateHeaders(templateLoader) + result;
-    data["globalVariables"] = generateGlobalVariables(templateLoader);
+    // The vertex struct goes right after the includes, so it travels inside the header fragment
+    std::string vertexStruct = Fragment::placeholder("headers");
+    model->generateVertexStructFilePart1(vertexStruct);
+    vertexData->generateVertexBindings(vertexStruct);
+    colorData->generateColorBindings(vertexStruct);
+    textureData->generateTextureBindings(vertexStruct);
+    model->generateVertexStructFilePart2(vertexStruct);
+
+    // The loader stages the editor runs as well, pasted as they are once Vertex is declared
+    std::map<std::string, FragmentPtr> headerChildren = { { "headers", headers } };
+    if (model->usesMeshLoader()) {
+        vertexStruct += "\n" + Fragment::placeholder("meshLoader");
+        headerChildren["meshLoader"] = templateLoader.renderTemplateFile("vulkan_templates/meshLoader.h", inja::json::object());
+    }
 
     fillOutputData(settings);
-    outputData["model"] = model->generateModel(templateLoader);
-    data["pipeline"] = templateLoader.renderTemplateFile("vulkan_templates/pipeline.txt", outputData);
+    outputData["bindlessTextures"] = model->bindlessTextures;
+    outputData["sharedObjectData"] = model->usesSharedObjectData();
+    outputData["vertexShaderPath"] = vertexShaderPath;
+    outputData["fragmentShaderPath"] = fragmentShaderPath;
+    outputData["model"] = Fragment::placeholder("model");
+    FragmentPtr pipeline = templateLoader.renderTemplateFile("vulkan_templates/pipeline.txt", outputData);
+
+    data["header"] = Fragment::placeholder("header");
+    data["globalVariables"] = Fragment::placeholder("globalVariables");
+    data["pipeline"] = Fragment::placeholder("pipeline");
+    FragmentPtr renderer = templateLoader.renderTemplateFile("vulkan_templates/class.txt", data);
+
+    return renderer->withChildren({
+        { "header", Fragment::fromText(std::move(vertexStruct), std::move(headerChildren)) },
+        { "globalVariables", globalVariables },
+        { "pipeline", pipeline->withChildren({ { "model", modelFragment.get() } }) }
+    });
+}
+
+// Only a meson.build written by the generator may be replaced, never the build file of the project around it
+static bool isGeneratedBuildFile(const std::filesystem::path& buildFile) {
+    std::ifstream inFile(buildFile);
+    std::string firstLine;
+    std::getline(inFile, firstLine);
+    return firstLine.rfind("# Generated by gve", 0) == 0;
+}
+
+bool PipelineNode::generate(TemplateLoader& templateLoader, const PipelineSettings& settings, const std::string& outputPath, bool splitOutput) {
+    FragmentPtr renderer = generateFragment(templateLoader, settings, splitOutput);
+    if (!renderer) return false;
+
+    std::filesystem::path rendererPath = outputPath;
+    if (splitOutput && rendererPath.has_parent_path()) {
+        std::filesystem::create_directories(rendererPath.parent_path());
+    }
+
+    if (!renderer->writeToFile(outputPath)) return false;
+
+    // Pre-cooked here, the first run of the renderer does not pay for the OBJ either
+    if (model->cookedMesh && !cookMesh(model->modelPath, model->optimizeMesh)) {
+        std::cerr << "Could not cook " << model->modelPath << ", the renderer cooks it on its first run\n";
+    }
+    if (model->compressedTextures && !cookTexture(model->texturePath)) {
+        std::cerr << "Could not cook " << model->texturePath << ", the renderer loads it uncompressed\n";
+    }
+
+    if (!splitOutput) return true;
+
+    inja::json projectData;
+    projectData["renderer"] = rendererPath.filename().string();
+
+    std::filesystem::path thirdPartyPath = rendererPath.parent_path() / "third_party.cpp";
+    if (!templateLoader.renderTemplateFile("vulkan_templates/thirdParty.txt", projectData)->writeToFile(thirdPartyPath.string())) {
+        return false;
+    }
+
+    std::filesystem::path buildFile = rendererPath.parent_path() / "meson.build";
+    if (std::filesystem::exists(buildFile) && !isGeneratedBuildFile(buildFile)) {
+        std::cerr << "Not overwriting " << buildFile.string() << ", it was not written by the generator\n";
+        return false;
+    }
+    return templateLoader.renderTemplateFile("vulkan_templates/mesonBuild.txt", projectData)->writeToFile(buildFile.string());
+}
+
+void PipelineNode::copyInputsFrom(const PipelineNode& other) {
+    model = other.model;
+    vertexData = other.vertexData;
+    colorData = other.colorData;
+    textureData = other.textureData;
+}
+
+void to_json(inja::json& j, const PipelineSettings& settings) {
+    j["inputAssembly"] = settings.inputAssembly;
+    j["primitiveRestart"] = settings.primitiveRestart;
+
+    j["depthClamp"] = settings.depthClamp;
+    j["rasterizerDiscard"] = settings.rasterizerDiscard;
+    j["polygonMode"] = settings.polygonMode;
+    j["lineWidth"] = settings.lineWidth;
+    j["cullMode"] = settings.cullMode;
+    j["frontFace"] = settings.frontFace;
+    j["depthBiasEnabled"] = settings.depthBiasEnabled;
+
+    j["depthTest"] = settings.depthTest;
+    j["depthWrite"] = settings.depthWrite;
+    j["depthCompareOp"] = settings.depthCompareOp;
+    j["depthBoundsTest"] = settings.depthBoundsTest;
+    j["stencilTest"] = settings.stencilTest;
+
+    j["sampleShading"] = settings.sampleShading;
+    j["rasterizationSamples"] = settings.rasterizationSamples;
+
+    j["colorWriteMask"] = settings.colorWriteMask;
+    j["colorBlend"] = settings.colorBlend;
+    j["logicOpEnable"] = settings.logicOpEnable;
+    j["logicOp"] = settings.logicOp;
+    j["attachmentCount"] = settings.attachmentCount;
+    j["blendConstants"] = settings.blendConstants;
+
+    j["vertexShaderPath"] = settings.vertexShaderPath;
+    j["vertexEntryName"] = settings.vertexEntryName;
+    j["fragmentShaderPath"] = settings.fragmentShaderPath;
+    j["fragmentEntryName"] = settings.fragmentEntryName;
+}
+
+// Missing keys keep their current value, so a graph file only needs to list what it changes.
+void from_json(const inja::json& j, PipelineSettings& settings) {
+    settings.inputAssembly = j.value("inputAssembly", settings.inputAssembly);
+    settings.primitiveRestart = j.value("primitiveRestart", settings.primitiveRestart);
+
+    settings.depthClamp = j.value("depthClamp", settings.depthClamp);
+    settings.rasterizerDiscard = j.value("rasterizerDiscard", settings.rasterizerDiscard);
+    settings.polygonMode = j.value("polygonMode", settings.polygonMode);
+    settings.lineWidth = j.value("lineWidth", settings.lineWidth);
+    settings.cullMode = j.value("cullMode", settings.cullMode);
+    settings.frontFace = j.value("frontFace", settings.frontFace);
+    settings.depthBiasEnabled = j.value("depthBiasEnabled", settings.depthBiasEnabled);
+
+    settings.depthTest = j.value("depthTest", settings.depthTest);
+    settings.depthWrite = j.value("depthWrite", settings.depthWrite);
+    settings.depthCompareOp = j.value("depthCompareOp", settings.depthCompareOp);
+    settings.depthBoundsTest = j.value("depthBoundsTest", settings.depthBoundsTest);
+    settings.stencilTest = j.value("stencilTest", settings.stencilTest);
+
+    settings.sampleShading = j.value("sampleShading", settings.sampleShading);
+    settings.rasterizationSamples = j.value("rasterizationSamples", settings.rasterizationSamples);
+
+    settings.colorWriteMask = j.value("colorWriteMask", settings.colorWriteMask);
+    settings.colorBlend = j.value("colorBlend", settings.colorBlend);
+    settings.logicOpEnable = j.value("logicOpEnable", settings.logicOpEnable);
+    settings.logicOp = j.value("logicOp", settings.logicOp);
+    settings.attachmentCount = j.value("attachmentCount", settings.attachmentCount);
+    if (j.contains("blendConstants")) {
+        for (int i = 0; i < 4; i++) {
+            settings.blendConstants[i] = j.at("blendConstants").at(i).get<float>();
+        }
+    }
 
-    outFile << templateLoader.renderTemplateFile("vulkan_templates/class.txt", data);
-    outFile.close();
+    copyString(settings.vertexShaderPath, j.value("vertexShaderPath", std::string(settings.vertexShaderPath)));
+    copyString(settings.vertexEntryName, j.value("vertexEntryName", std::string(settings.vertexEntryName)));
+    copyString(settings.fragmentShaderPath, j.value("fragmentShaderPath", std::string(settings.fragmentShaderPath)));
+    copyString(settings.fragmentEntryName, j.value("fragmentEntryName", std::string(settings.fragmentEntryName)));
 }
@@ -1,3 +1,4 @@
+#pragma once
 #include "model.h"
 #include "template_loader.h"
 #include <optional>
@@ -35,10 +36,12 @@ struct PipelineSettings {
     char fragmentEntryName[64] = "main";
 };
 
+void to_json(inja::json& j, const PipelineSettings& settings);
+void from_json(const inja::json& j, PipelineSettings& settings);
+
 class PipelineNode : public Node {
 public:
 	std::optional<PipelineSettings> settings = PipelineSettings{};
-	std::ofstream outFile;
     PipelineNode(int id);
 
     ~PipelineNode() override;
@@ -47,7 +50,9 @@ public:
 
     void fillOutputData(const PipelineSettings& settings);
 
-    void generate(TemplateLoader templateLoader, const PipelineSettings& settings);
+    FragmentPtr generateFragment(TemplateLoader& templateLoader, const PipelineSettings& settings, bool splitOutput = false);
+    // splitOutput also writes third_party.cpp and a meson.build next to outputPath
+    bool generate(TemplateLoader& templateLoader, const PipelineSettings& settings, const std::string& outputPath, bool splitOutput = false);
 
     void setModel(ModelNode *model) {
         this->model = model;
@@ -65,7 +70,12 @@ public:
         this->textureData = textureData;
     }
 
+    // Wires this node to the same model and data inputs as other
+    void copyInputsFrom(const PipelineNode& other);
+
 private:
+    bool checkVertexShader(const std::string& vertexShaderPath) const;
+
 	ModelNode *model = nullptr;
     VertexDataNode *vertexData = nullptr;
     ColorDataNode *colorData = nullptr;
@@ -6,9 +6,10 @@ RenderPassNode::~RenderPassNode() { }
 
 void RenderPassNode::render() const {}
 
-std::string RenderPassNode::generateRenderpass(TemplateLoader templateLoader) {
+FragmentPtr RenderPassNode::generateRenderpass(TemplateLoader& templateLoader) {
     SwapchainNode swapchain{id};
 
-    data["swapchain"] = swapchain.generateSwapchain(templateLoader);
-    return templateLoader.renderTemplateFile("vulkan_templates/renderpass.txt", data);
+    data["swapchain"] = Fragment::placeholder("swapchain");
+    return templateLoader.renderTemplateFile("vulkan_templates/renderpass.txt", data,
+        { { "swapchain", swapchain.generateSwapchain(templateLoader) } });
 }
@@ -8,7 +8,7 @@ public:
 	~RenderPassNode() override;
 
 	void render() const override;
-	std::string generateRenderpass(TemplateLoader templateLoader);
+	FragmentPtr generateRenderpass(TemplateLoader& templateLoader);
 private:
 	inja::json data;
 };
@@ -0,0 +1,74 @@
+#include "shader.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+
+namespace {
+
+constexpr uint32_t spirvMagic = 0x07230203;
+constexpr uint32_t opEntryPoint = 15;
+constexpr uint32_t opVariable = 59;
+constexpr uint32_t opDecorate = 71;
+constexpr uint32_t executionModelVertex = 0;
+constexpr uint32_t storageClassInput = 1;
+constexpr uint32_t decorationLocation = 30;
+
+// Words taken by a literal string operand, NUL included
+size_t stringWords(const std::vector<uint32_t>& words, size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+        if ((words[i] >> 24) == 0) return i + 1 - start;
+    }
+    return end - start;
+}
+
+}
+
+bool readVertexInputLocations(const std::string& fileName, std::vector<uint32_t>& locations) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 5 * sizeof(uint32_t) || bytes.size() % sizeof(uint32_t) != 0) return false;
+
+    std::vector<uint32_t> words(bytes.size() / sizeof(uint32_t));
+    std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(words.data()));
+    if (words[0] != spirvMagic) return false;
+
+    std::set<uint32_t> interface;
+    std::set<uint32_t> inputs;
+    std::map<uint32_t, uint32_t> locationOf;
+    for (size_t i = 5; i < words.size();) {
+        uint32_t wordCount = words[i] >> 16;
+        uint32_t opcode = words[i] & 0xFFFF;
+        if (wordCount == 0 || i + wordCount > words.size()) return false;
+
+        if (opcode == opEntryPoint && wordCount > 3 && words[i + 1] == executionModelVertex) {
+            size_t first = i + 3 + stringWords(words, i + 3, i + wordCount);
+            interface.insert(words.begin() + first, words.begin() + i + wordCount);
+        } else if (opcode == opVariable && wordCount >= 4 && words[i + 3] == storageClassInput) {
+            inputs.insert(words[i + 2]);
+        } else if (opcode == opDecorate && wordCount >= 4 && words[i + 2] == decorationLocation) {
+            locationOf[words[i + 1]] = words[i + 3];
+        }
+        i += wordCount;
+    }
+
+    locations.clear();
+    for (uint32_t id : interface) {
+        auto location = locationOf.find(id);
+        if (inputs.count(id) && location != locationOf.end()) locations.push_back(location->second);
+    }
+    std::sort(locations.begin(), locations.end());
+    return true;
+}
+
+bool isSpirvFile(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    uint32_t magic = 0;
+    return file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) && magic == spirvMagic;
+}
+
+std::string shaderSourcePath(const std::string& modulePath) {
+    return std::filesystem::path(modulePath).replace_extension(".slang").string();
+}
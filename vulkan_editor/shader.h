@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Locations of the inputs the vertex entry points of a SPIR-V module read, built-ins excluded.
+// False when the file is missing or is not SPIR-V.
+bool readVertexInputLocations(const std::string& fileName, std::vector<uint32_t>& locations);
+
+// The file starts with the SPIR-V magic number
+bool isSpirvFile(const std::string& fileName);
+
+// shaders/vert.slang for shaders/vert.spv, the source compile.sh builds a module from
+std::string shaderSourcePath(const std::string& modulePath);
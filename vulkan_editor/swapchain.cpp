@@ -6,10 +6,11 @@ SwapchainNode::~SwapchainNode() { }
 
 void SwapchainNode::render() const {}
 
-std::string SwapchainNode::generateSwapchain(TemplateLoader templateLoader) {
+FragmentPtr SwapchainNode::generateSwapchain(TemplateLoader& templateLoader) {
 
 	LogicalDeviceNode logicalDevice{id};
-	data["logicalDevice"] = logicalDevice.generateLogicalDevice(templateLoader);
+	data["logicalDevice"] = Fragment::placeholder("logicalDevice");
 
-	return templateLoader.renderTemplateFile("vulkan_templates/swapchain.txt", data);
+	return templateLoader.renderTemplateFile("vulkan_templates/swapchain.txt", data,
+		{ { "logicalDevice", logicalDevice.generateLogicalDevice(templateLoader) } });
 }
@@ -8,7 +8,7 @@ public:
     ~SwapchainNode() override;
 
     void render() const override;
-    std::string generateSwapchain(TemplateLoader templateLoader);
+    FragmentPtr generateSwapchain(TemplateLoader& templateLoader);
 private:
 	inja::json data;
 };
@@ -1,14 +1,224 @@
 #include "template_loader.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
-void TemplateLoader::loadTemplateFile(const std::string fileName) {
-	inja::Template temp = env.parse_template(fileName);
-	templates[fileName] =  temp;
+static void configureEnvironment(inja::Environment& env) {
+	// Lines holding only a {% statement %} leave nothing behind in the generated code
+	env.set_trim_blocks(true);
+	env.set_lstrip_blocks(true);
 }
 
-std::string TemplateLoader::renderTemplateFile(const std::string fileName, inja::json data) {
-	inja::Template temp = templates.at(fileName);
-	std::string result = "";
-	//std::string result = env.render("{% include \"" + fileName + "\" %}", data);
-	result += env.render(temp, data);
-	return result;
+void FragmentTask::State::run() {
+	if (claimed.exchange(true)) return;
+	try {
+		promise.set_value(function());
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+	}
+}
+
+FragmentPtr FragmentTask::get() {
+	state->run();
+	return state->result.get();
+}
+
+TemplateLoader::TemplateLoader() {
+	configureEnvironment(env);
+}
+
+TemplateLoader::~TemplateLoader() {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueReady.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void TemplateLoader::startWorkers() {
+	unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int i = 0; i < workerCount; i++) {
+		workers.emplace_back([this] {
+			while (true) {
+				std::shared_ptr<FragmentTask::State> task;
+				{
+					std::unique_lock<std::mutex> lock(queueMutex);
+					queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+					if (queue.empty()) return;
+					task = std::move(queue.front());
+					queue.pop_front();
+				}
+				// Tasks that a waiting get() already ran are skipped
+				task->run();
+			}
+		});
+	}
+}
+
+FragmentTask TemplateLoader::spawn(std::function<FragmentPtr()> function) {
+	FragmentTask task;
+	task.state = std::make_shared<FragmentTask::State>();
+	task.state->function = std::move(function);
+	if (!parallel) return task;
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (workers.empty()) startWorkers();
+		queue.push_back(task.state);
+	}
+	queueReady.notify_one();
+	return task;
+}
+
+void TemplateLoader::loadTemplateFile(const std::string& fileName) {
+	// Only registers the file, parsing waits until it is first rendered
+	templates.try_emplace(fileName);
+}
+
+std::shared_ptr<const inja::Template> TemplateLoader::getTemplate(const std::string& fileName) {
+	std::lock_guard<std::mutex> lock(mutex);
+	TemplateEntry& entry = templates.at(fileName);
+
+	// Only the mtime and size are checked per render, the file is read and hashed once either changes
+	std::filesystem::file_time_type modified = std::filesystem::last_write_time(fileName);
+	uintmax_t size = std::filesystem::file_size(fileName);
+	if (entry.parsed && modified == entry.modified && size == entry.size) {
+		return entry.parsed;
+	}
+
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		throw std::runtime_error("Error opening template " + fileName);
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	std::string content = buffer.str();
+
+	// A touched file with unchanged content keeps its parsed template
+	size_t contentHash = std::hash<std::string>{}(content);
+	if (!entry.parsed || contentHash != entry.contentHash) {
+		entry.parsed = std::make_shared<const inja::Template>(env.parse(content));
+		entry.contentHash = contentHash;
+		entry.rendered.clear();
+	}
+	entry.modified = modified;
+	entry.size = size;
+
+	return entry.parsed;
+}
+
+FragmentPtr TemplateLoader::renderTemplateFile(const std::string& fileName, const inja::json& data, std::map<std::string, FragmentPtr> children) {
+	std::chrono::steady_clock::time_point start;
+	if (profiling) start = std::chrono::steady_clock::now();
+
+	std::shared_ptr<const inja::Template> parsed = getTemplate(fileName);
+
+	// Equal hashes still compare the data, a collision just renders again
+	size_t dataHash = 0;
+	if (maxRenderedFragments > 0) {
+		dataHash = std::hash<inja::json>{}(data);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		TemplateEntry& entry = templates.at(fileName);
+		auto cached = entry.rendered.find(dataHash);
+		if (cached != entry.rendered.end() && cached->second.data == data) {
+			std::shared_ptr<const std::string> output = cached->second.output;
+			lock.unlock();
+			if (profiling) recordRender(fileName, start, output->size(), data, true);
+			return std::make_shared<Fragment>(output, std::move(children));
+		}
+	}
+
+	// Parsing writes to env while other threads render, so renders go through a per-thread environment
+	thread_local inja::Environment renderEnvironment = [] {
+		inja::Environment environment;
+		configureEnvironment(environment);
+		return environment;
+	}();
+	auto output = std::make_shared<const std::string>(renderEnvironment.render(*parsed, data));
+
+	if (maxRenderedFragments > 0) {
+		std::lock_guard<std::mutex> lock(mutex);
+		TemplateEntry& entry = templates.at(fileName);
+		// Skip storing if the template was reparsed while this render ran
+		if (entry.parsed == parsed) {
+			if (entry.rendered.size() >= maxRenderedFragments) {
+				entry.rendered.clear();
+			}
+			entry.rendered.insert_or_assign(dataHash, RenderedFragment{ data, output });
+		}
+	}
+
+	if (profiling) recordRender(fileName, start, output->size(), data, false);
+	return std::make_shared<Fragment>(output, std::move(children));
+}
+
+void TemplateLoader::recordRender(const std::string& fileName, std::chrono::steady_clock::time_point start, size_t outputBytes, const inja::json& data, bool cacheHit) {
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	size_t inputBytes = data.dump().size();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	TemplateProfile& profile = profiles[fileName];
+	profile.calls++;
+	if (cacheHit) profile.cacheHits++;
+	profile.totalMs += elapsedMs;
+	profile.maxMs = std::max(profile.maxMs, elapsedMs);
+	profile.outputBytes += outputBytes;
+	profile.inputBytes += inputBytes;
+}
+
+void TemplateLoader::resetProfile() {
+	std::lock_guard<std::mutex> lock(mutex);
+	profiles.clear();
+}
+
+void TemplateLoader::printProfile(std::ostream& out) {
+	std::vector<std::pair<std::string, TemplateProfile>> sorted;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		sorted.assign(profiles.begin(), profiles.end());
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.totalMs > b.second.totalMs; });
+
+	out << std::left << std::setw(40) << "template" << std::right
+	    << std::setw(8) << "calls" << std::setw(8) << "hits"
+	    << std::setw(12) << "total ms" << std::setw(12) << "max ms"
+	    << std::setw(12) << "out bytes" << std::setw(12) << "in bytes" << "\n";
+	for (const auto& [fileName, profile] : sorted) {
+		out << std::left << std::setw(40) << fileName << std::right
+		    << std::setw(8) << profile.calls << std::setw(8) << profile.cacheHits
+		    << std::setw(12) << std::fixed << std::setprecision(3) << profile.totalMs
+		    << std::setw(12) << profile.maxMs
+		    << std::setw(12) << profile.outputBytes << std::setw(12) << profile.inputBytes << "\n";
+	}
+	out << std::defaultfloat;
+}
+
+bool TemplateLoader::writeProfile(const std::string& fileName) {
+	inja::json report = inja::json::object();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const auto& [templateName, profile] : profiles) {
+			report[templateName] = {
+				{ "calls", profile.calls },
+				{ "cacheHits", profile.cacheHits },
+				{ "totalMs", profile.totalMs },
+				{ "maxMs", profile.maxMs },
+				{ "outputBytes", profile.outputBytes },
+				{ "inputBytes", profile.inputBytes }
+			};
+		}
+	}
+
+	std::ofstream outFile(fileName, std::ios::trunc);
+	if (!outFile.is_open()) {
+		std::cerr << "Error opening " << fileName << " for writing.\n";
+		return false;
+	}
+	outFile << report.dump(4) << "\n";
+	return true;
 }
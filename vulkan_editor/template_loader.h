@@ -1,15 +1,135 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <inja/inja.hpp>
+#include "fragment.h"
+
+// Every template the code generators render, relative to the working directory.
+// Inline so it is initialized before the global Editor that loads it.
+inline const std::vector<std::string> templateFileNames = {
+	"vulkan_templates/class.txt",
+	"vulkan_templates/application.txt",
+	"vulkan_templates/buffer.txt",
+	"vulkan_templates/globalVariables.txt",
+	"vulkan_templates/header.txt",
+	"vulkan_templates/image.txt",
+	"vulkan_templates/instance.txt",
+	"vulkan_templates/logicalDevice.txt",
+	"vulkan_templates/model.txt",
+	"vulkan_templates/physicalDevice.txt",
+	"vulkan_templates/pipeline.txt",
+	"vulkan_templates/renderpass.txt",
+	"vulkan_templates/swapchain.txt",
+	"vulkan_templates/utils.txt",
+	"vulkan_templates/thirdParty.txt",
+	"vulkan_templates/mesonBuild.txt",
+	"vulkan_templates/meshLoader.h",
+};
+
+// Output of one render, kept with the data it was rendered from.
+struct RenderedFragment {
+	inja::json data;
+	std::shared_ptr<const std::string> output;
+};
+
+// A template is parsed on its first render and again only once its source has changed.
+// Parsed templates stay in memory only: inja cannot serialize them, and parsing all of vulkan_templates takes about a millisecond.
+// Renders are memoized by a hash of their input data and dropped when the template is reparsed.
+struct TemplateEntry {
+	std::shared_ptr<const inja::Template> parsed;
+	std::filesystem::file_time_type modified;
+	uintmax_t size = 0;
+	size_t contentHash = 0;
+	std::unordered_map<size_t, RenderedFragment> rendered;
+};
+
+// Render statistics of one template while profiling is on. Output bytes count the template's own text,
+// nested fragments are counted under their own template.
+struct TemplateProfile {
+	size_t calls = 0;
+	size_t cacheHits = 0;
+	double totalMs = 0.0;
+	double maxMs = 0.0;
+	size_t outputBytes = 0;
+	size_t inputBytes = 0;
+};
+
+// A fragment render queued on the loader's worker pool. get() runs it in place when no worker has
+// picked it up yet, so a fragment waiting on its children never holds a worker they need.
+class FragmentTask {
+	public:
+	FragmentPtr get();
+
+	private:
+	friend class TemplateLoader;
+	struct State {
+		std::function<FragmentPtr()> function;
+		std::atomic<bool> claimed{ false };
+		std::promise<FragmentPtr> promise;
+		std::future<FragmentPtr> result = promise.get_future();
+
+		void run();
+	};
+	std::shared_ptr<State> state;
+};
 
 class TemplateLoader {
 	public:
+	// Parses only, under mutex. Every thread renders through an environment of its own.
 	inja::Environment env;
-	std::map<const std::string, inja::Template> templates;
+	std::map<const std::string, TemplateEntry> templates;
+	// Bounds the memoized renders per template, batch generation would otherwise keep every variant.
+	// 0 turns memoization off.
+	size_t maxRenderedFragments = 16;
+	// Independent fragments render on their own threads, off renders them in place
+	bool parallel = true;
+	// Times every render per template, costs an extra dump of each input
+	bool profiling = false;
+	std::map<std::string, TemplateProfile> profiles;
+	// Guards env, templates and profiles
+	std::mutex mutex;
+
+	TemplateLoader();
+	~TemplateLoader();
+
+	// Holds the environment and every parsed template, so it is only ever passed by reference.
+	TemplateLoader(const TemplateLoader&) = delete;
+	TemplateLoader& operator=(const TemplateLoader&) = delete;
+
+	void loadTemplateFile(const std::string& fileName);
+	std::shared_ptr<const inja::Template> getTemplate(const std::string& fileName);
+	// children are the fragments data refers to through Fragment::placeholder
+	FragmentPtr renderTemplateFile(const std::string& fileName, const inja::json& data, std::map<std::string, FragmentPtr> children = {});
+
+	void resetProfile();
+	// Slowest templates first
+	void printProfile(std::ostream& out);
+	bool writeProfile(const std::string& fileName);
+
+	// Queued on a pool of one worker per core, with parallel off the task runs when get() is called
+	FragmentTask spawn(std::function<FragmentPtr()> function);
+
+	private:
+	void recordRender(const std::string& fileName, std::chrono::steady_clock::time_point start, size_t outputBytes, const inja::json& data, bool cacheHit);
+	void startWorkers();
 
-	void loadTemplateFile(const std::string fileName);
-	std::string renderTemplateFile(const std::string fileName, inja::json data);
+	std::vector<std::thread> workers;
+	std::deque<std::shared_ptr<FragmentTask::State>> queue;
+	std::mutex queueMutex;
+	std::condition_variable queueReady;
+	bool stopping = false;
 };
@@ -0,0 +1,382 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "texture.h"
+#include "../libs/stb_image.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vulkan/vulkan.h>
+
+namespace {
+
+float srgbToLinear(int value) {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> table{};
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+    return table[value];
+}
+
+uint8_t linearToSrgb(float value) {
+    static const std::array<uint8_t, 4096> table = [] {
+        std::array<uint8_t, 4096> table{};
+        for (int i = 0; i < 4096; i++) {
+            float c = i / 4095.0f;
+            float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            table[i] = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+        }
+        return table;
+    }();
+    return table[std::clamp(static_cast<int>(value * 4095.0f + 0.5f), 0, 4095)];
+}
+
+uint16_t packColor(const float* color) {
+    int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+void unpackColor(uint16_t packed, int* color) {
+    int r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = r << 3 | r >> 2;
+    color[1] = g << 2 | g >> 4;
+    color[2] = b << 3 | b >> 2;
+}
+
+// Nearest of the four colors per pixel, returns the squared error. color0 > color1 selects the four color mode.
+int colorIndices(const uint8_t* block, uint16_t color0, uint16_t color1, uint32_t& indices) {
+    int palette[4][3];
+    unpackColor(color0, palette[0]);
+    unpackColor(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    indices = 0;
+    int error = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        int bestError = INT_MAX;
+        for (int p = 0; p < 4; p++) {
+            int dr = block[i * 4] - palette[p][0];
+            int dg = block[i * 4 + 1] - palette[p][1];
+            int db = block[i * 4 + 2] - palette[p][2];
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestError) {
+                best = p;
+                bestError = distance;
+            }
+        }
+        indices |= static_cast<uint32_t>(best) << (2 * i);
+        error += bestError;
+    }
+    return error;
+}
+
+int fitColors(const uint8_t* block, const float* end0, const float* end1, uint16_t& color0, uint16_t& color1, uint32_t& indices) {
+    color0 = packColor(end0);
+    color1 = packColor(end1);
+    if (color0 < color1) std::swap(color0, color1);
+    return colorIndices(block, color0, color1, indices);
+}
+
+// BC1 color block: endpoints at the extremes of the principal axis, then one least squares pass over the chosen indices
+void encodeColorBlock(const uint8_t* block, uint8_t* out) {
+    float mean[3] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) mean[c] += block[i * 4 + c] / 16.0f;
+    }
+    float covariance[3][3] = {};
+    for (int i = 0; i < 16; i++) {
+        float d[3] = { block[i * 4] - mean[0], block[i * 4 + 1] - mean[1], block[i * 4 + 2] - mean[2] };
+        for (int a = 0; a < 3; a++) {
+            for (int b = 0; b < 3; b++) covariance[a][b] += d[a] * d[b];
+        }
+    }
+
+    // Power iteration from the channel that varies most
+    int start = 0;
+    for (int c = 1; c < 3; c++) {
+        if (covariance[c][c] > covariance[start][start]) start = c;
+    }
+    float axis[3] = { covariance[0][start], covariance[1][start], covariance[2][start] };
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3];
+        for (int a = 0; a < 3; a++) next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+        float length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+        if (length == 0.0f) break;
+        for (int a = 0; a < 3; a++) axis[a] = next[a] / length;
+    }
+
+    int minPixel = 0, maxPixel = 0;
+    float minProjection = INFINITY, maxProjection = -INFINITY;
+    for (int i = 0; i < 16; i++) {
+        float projection = block[i * 4] * axis[0] + block[i * 4 + 1] * axis[1] + block[i * 4 + 2] * axis[2];
+        if (projection < minProjection) {
+            minProjection = projection;
+            minPixel = i;
+        }
+        if (projection > maxProjection) {
+            maxProjection = projection;
+            maxPixel = i;
+        }
+    }
+
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; c++) {
+        end0[c] = block[maxPixel * 4 + c];
+        end1[c] = block[minPixel * 4 + c];
+    }
+    uint16_t color0, color1;
+    uint32_t indices;
+    int error = fitColors(block, end0, end1, color0, color1, indices);
+
+    // Weight of color0 per index in the four color mode
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; i++) {
+        float w = weights[(indices >> (2 * i)) & 3];
+        aa += w * w;
+        ab += w * (1.0f - w);
+        bb += (1.0f - w) * (1.0f - w);
+        for (int c = 0; c < 3; c++) {
+            ax[c] += w * block[i * 4 + c];
+            bx[c] += (1.0f - w) * block[i * 4 + c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (error > 0 && std::abs(determinant) > 1e-6f) {
+        for (int c = 0; c < 3; c++) {
+            end0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+            end1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+        }
+        uint16_t refined0, refined1;
+        uint32_t refinedIndices;
+        if (fitColors(block, end0, end1, refined0, refined1, refinedIndices) < error) {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refinedIndices;
+        }
+    }
+
+    std::memcpy(out, &color0, 2);
+    std::memcpy(out + 2, &color1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// BC3 alpha block in the eight value mode, alpha0 > alpha1
+void encodeAlphaBlock(const uint8_t* block, uint8_t* out) {
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; i++) {
+        minAlpha = std::min<int>(minAlpha, block[i * 4 + 3]);
+        maxAlpha = std::max<int>(maxAlpha, block[i * 4 + 3]);
+    }
+    std::memset(out, 0, 8);
+    out[0] = static_cast<uint8_t>(maxAlpha);
+    out[1] = static_cast<uint8_t>(minAlpha);
+    if (minAlpha == maxAlpha) return;
+
+    int palette[8] = { maxAlpha, minAlpha };
+    for (int k = 1; k < 7; k++) palette[k + 1] = ((7 - k) * maxAlpha + k * minAlpha) / 7;
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        for (int p = 1; p < 8; p++) {
+            if (std::abs(block[i * 4 + 3] - palette[p]) < std::abs(block[i * 4 + 3] - palette[best])) best = p;
+        }
+        indices |= static_cast<uint64_t>(best) << (3 * i);
+    }
+    for (int b = 0; b < 6; b++) out[2 + b] = static_cast<uint8_t>(indices >> (8 * b));
+}
+
+std::vector<uint8_t> compressLevel(const uint8_t* pixels, uint32_t width, uint32_t height, bool alpha) {
+    uint32_t blocksWide = (width + 3) / 4;
+    uint32_t blocksHigh = (height + 3) / 4;
+    size_t blockBytes = alpha ? 16 : 8;
+    std::vector<uint8_t> blocks(size_t(blocksWide) * blocksHigh * blockBytes);
+
+    uint8_t block[64];
+    for (uint32_t by = 0; by < blocksHigh; by++) {
+        for (uint32_t bx = 0; bx < blocksWide; bx++) {
+            // Blocks past the edge repeat the last row and column
+            for (uint32_t y = 0; y < 4; y++) {
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, width - 1);
+                    uint32_t sy = std::min(by * 4 + y, height - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, pixels + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+            uint8_t* out = blocks.data() + (size_t(by) * blocksWide + bx) * blockBytes;
+            if (alpha) {
+                encodeAlphaBlock(block, out);
+                out += 8;
+            }
+            encodeColorBlock(block, out);
+        }
+    }
+    return blocks;
+}
+
+// Data format descriptor of the two formats compressImage writes, a basic block with one sample per BC channel
+std::vector<uint32_t> dataFormatDescriptor(uint32_t format) {
+    bool alpha = format == VK_FORMAT_BC3_SRGB_BLOCK;
+    uint32_t sampleCount = alpha ? 2 : 1;
+    uint32_t blockSize = 24 + 16 * sampleCount;
+
+    std::vector<uint32_t> words;
+    words.push_back(4 + blockSize);             // dfdTotalSize
+    words.push_back(0);                         // Khronos vendor, basic descriptor type
+    words.push_back(2 | blockSize << 16);       // version 1.3
+    words.push_back((alpha ? 130 : 128) | 1 << 8 | 2 << 16);   // BC3 or BC1A color model, BT.709 primaries, sRGB transfer
+    words.push_back(3 | 3 << 8);                // 4x4 texel blocks
+    words.push_back(alpha ? 16 : 8);            // bytes per block
+    words.push_back(0);
+    if (alpha) {
+        // Alpha is linear in an sRGB texture
+        words.insert(words.end(), { 0 | 63 << 16 | (15 | 0x10) << 24, 0, 0, UINT32_MAX });
+    }
+    words.insert(words.end(), { (alpha ? 64u : 0u) | 63 << 16, 0, 0, UINT32_MAX });
+    return words;
+}
+
+} // namespace
+
+std::string compressedTexturePath(const std::string& texturePath) {
+    return texturePath + ".ktx2";
+}
+
+std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height) {
+    std::vector<std::vector<uint8_t>> chain;
+    chain.emplace_back(pixels, pixels + size_t(width) * height * 4);
+    while (width > 1 || height > 1) {
+        const std::vector<uint8_t>& source = chain.back();
+        uint32_t targetWidth = std::max(width / 2, 1u);
+        uint32_t targetHeight = std::max(height / 2, 1u);
+        std::vector<uint8_t> target(size_t(targetWidth) * targetHeight * 4);
+
+        for (uint32_t y = 0; y < targetHeight; y++) {
+            // Odd sizes clamp, the last row and column are averaged with themselves
+            const uint8_t* row0 = source.data() + size_t(std::min(2 * y, height - 1)) * width * 4;
+            const uint8_t* row1 = source.data() + size_t(std::min(2 * y + 1, height - 1)) * width * 4;
+            for (uint32_t x = 0; x < targetWidth; x++) {
+                uint32_t x0 = std::min(2 * x, width - 1) * 4;
+                uint32_t x1 = std::min(2 * x + 1, width - 1) * 4;
+                uint8_t* out = target.data() + (size_t(y) * targetWidth + x) * 4;
+                for (int c = 0; c < 3; c++) {
+                    float sum = srgbToLinear(row0[x0 + c]) + srgbToLinear(row0[x1 + c]) + srgbToLinear(row1[x0 + c]) + srgbToLinear(row1[x1 + c]);
+                    out[c] = linearToSrgb(sum / 4.0f);
+                }
+                out[3] = static_cast<uint8_t>((row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3]) / 4.0f + 0.5f);
+            }
+        }
+
+        chain.push_back(std::move(target));
+        width = targetWidth;
+        height = targetHeight;
+    }
+    return chain;
+}
+
+CompressedImage compressImage(const uint8_t* pixels, uint32_t width, uint32_t height) {
+    bool alpha = false;
+    for (size_t i = 0; i < size_t(width) * height && !alpha; i++) alpha = pixels[i * 4 + 3] != 255;
+
+    CompressedImage image;
+    image.format = alpha ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+    image.width = width;
+    image.height = height;
+    std::vector<std::vector<uint8_t>> chain = buildMipChain(pixels, width, height);
+    for (size_t level = 0; level < chain.size(); level++) {
+        image.levels.push_back(compressLevel(chain[level].data(), std::max(width >> level, 1u), std::max(height >> level, 1u), alpha));
+    }
+    return image;
+}
+
+bool writeKtx2(const CompressedImage& image, const std::string& fileName) {
+    static const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    std::vector<uint32_t> descriptor = dataFormatDescriptor(image.format);
+    uint32_t levelCount = static_cast<uint32_t>(image.levels.size());
+    uint32_t blockBytes = image.format == VK_FORMAT_BC3_SRGB_BLOCK ? 16 : 8;
+
+    uint32_t descriptorOffset = 80 + 24 * levelCount;
+    uint32_t descriptorLength = static_cast<uint32_t>(descriptor.size() * 4);
+    uint32_t header[13] = { static_cast<uint32_t>(image.format), 1, image.width, image.height, 0, 0, 1, levelCount, 0
+        , descriptorOffset, descriptorLength, 0, 0 };
+    uint64_t supercompression[2] = { 0, 0 };
+
+    // Smallest level first in the file, each aligned to its block size
+    std::vector<uint64_t> levelIndex(3 * levelCount);
+    uint64_t offset = descriptorOffset + descriptorLength;
+    for (uint32_t level = levelCount; level-- > 0;) {
+        offset = (offset + blockBytes - 1) / blockBytes * blockBytes;
+        levelIndex[3 * level] = offset;
+        levelIndex[3 * level + 1] = image.levels[level].size();
+        levelIndex[3 * level + 2] = image.levels[level].size();
+        offset += image.levels[level].size();
+    }
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(identifier), sizeof(identifier));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(supercompression), sizeof(supercompression));
+    file.write(reinterpret_cast<const char*>(levelIndex.data()), levelIndex.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(descriptor.data()), descriptorLength);
+    for (uint32_t level = levelCount; level-- > 0;) {
+        uint64_t padding = levelIndex[3 * level] - static_cast<uint64_t>(file.tellp());
+        static const char zeros[16] = {};
+        file.write(zeros, padding);
+        file.write(reinterpret_cast<const char*>(image.levels[level].data()), image.levels[level].size());
+    }
+    if (!file) {
+        std::cerr << "Error writing " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool cookTexture(const std::string& texturePath) {
+    std::string extension = std::filesystem::path(texturePath).extension().string();
+    if (extension == ".ktx2" || extension == ".dds") return true;
+
+    std::string cookedPath = compressedTexturePath(texturePath);
+    std::error_code error;
+    auto sourceTime = std::filesystem::last_write_time(texturePath, error);
+    if (error) {
+        std::cerr << "Error reading " << texturePath << ": " << error.message() << "\n";
+        return false;
+    }
+    auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+    if (!error && cookedTime >= sourceTime) return true;
+
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        std::cerr << "Error loading " << texturePath << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    CompressedImage image = compressImage(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    stbi_image_free(pixels);
+
+    // A renderer starting meanwhile never sees a half written file
+    std::string tempPath = cookedPath + ".tmp";
+    if (!writeKtx2(image, tempPath)) return false;
+    std::filesystem::rename(tempPath, cookedPath, error);
+    if (error) {
+        std::cerr << "Error replacing " << cookedPath << ": " << error.message() << "\n";
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Block compressed image with its mip chain, what the compressedTextures loader uploads
+struct CompressedImage {
+    uint32_t format = 0;    // VkFormat
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<std::vector<uint8_t>> levels;   // level 0 first
+};
+
+// <texture>.ktx2, the first file the generated findCompressedTexture looks for next to a PNG or JPG
+std::string compressedTexturePath(const std::string& texturePath);
+
+// Full mip chain of an RGBA8 sRGB image, 2x2 box filter in linear space like the generated buildMipChain
+std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height);
+
+// BC1 when every pixel is opaque, BC3 otherwise, all levels of the chain
+CompressedImage compressImage(const uint8_t* pixels, uint32_t width, uint32_t height);
+
+bool writeKtx2(const CompressedImage& image, const std::string& fileName);
+
+// Writes <texture>.ktx2 unless one newer than the texture exists. KTX2 and DDS textures are used as they are.
+bool cookTexture(const std::string& texturePath);
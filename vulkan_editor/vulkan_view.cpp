@@ -1,5 +1,6 @@
 #include "vulkan_view.h"
 #include "model.h"
+#include "graph.h"
 #include "template_loader.h"
 #include <vulkan/vulkan.h>
 
@@ -22,10 +23,44 @@ void Editor::nodeEditorInitialize() {
 }
 
 void Editor::saveFile() {
-    for (const auto& node : nodes) {
-        if (auto pipelineNode = dynamic_cast<PipelineNode*>(node.get())) {
-            pipelineNode->generate(templateLoader, pipelineNode->settings.value());
+    // Templates are parsed on demand, so a broken template surfaces here instead of at startup
+    // The split project brings its own meson.build, so it must not land next to the editor's
+    const std::string outputPath = splitOutput ? "generated/renderer.cpp" : "renderer.cpp";
+    templateLoader.profiling = profileGeneration;
+    templateLoader.resetProfile();
+    try {
+        for (const auto& node : nodes) {
+            if (auto pipelineNode = dynamic_cast<PipelineNode*>(node.get())) {
+                if (pipelineNode->generate(templateLoader, pipelineNode->settings.value(), outputPath, splitOutput)) {
+                    std::cout << "Code was successfully generated in " << outputPath << "\n";
+                }
+            }
         }
+    } catch (const std::exception& e) {
+        std::cerr << "Code generation failed: " << e.what() << "\n";
+    }
+
+    if (profileGeneration) {
+        templateLoader.printProfile(std::cout);
+        templateLoader.writeProfile("generation_profile.json");
+    }
+}
+
+void Editor::saveGraphFile() {
+    const char* filter[] = { "*.json" };
+    const char* selectedPath = tinyfd_saveFileDialog("Save Graph", "graph.json", 1, filter, "Graph Files");
+    if (selectedPath) {
+        saveGraph(selectedPath, nodes, links);
+    }
+}
+
+void Editor::loadGraphFile() {
+    const char* filter[] = { "*.json" };
+    const char* selectedPath = tinyfd_openFileDialog("Load Graph", "", 1, filter, "Graph Files", 0);
+    if (selectedPath && loadGraph(selectedPath, nodes, links, currentId)) {
+        // The previous nodes are gone, drop the selections pointing at them
+        selectedPipelineNode = nullptr;
+        selectedModelNode = nullptr;
     }
 }
 
@@ -148,6 +183,28 @@ void Editor::showPipelineView() {
     float buttonWidth = 200.0f;
     float padding = 12.0f;
 
+    float graphButtonWidth = 100.0f;
+
+    float splitCheckboxWidth = 120.0f;
+    float profileCheckboxWidth = 80.0f;
+
+    ImGui::SameLine();
+    // Graph file buttons and the output options sit to the left of the Generate button
+    ImGui::SetCursorPosX(windowWidth - buttonWidth - 2 * graphButtonWidth - splitCheckboxWidth - profileCheckboxWidth - 5 * padding);
+    ImGui::Checkbox("Profile", &profileGeneration);
+    ImGui::SameLine();
+    ImGui::SetCursorPosX(windowWidth - buttonWidth - 2 * graphButtonWidth - splitCheckboxWidth - 4 * padding);
+    ImGui::Checkbox("Split Output", &splitOutput);
+    ImGui::SameLine();
+    ImGui::SetCursorPosX(windowWidth - buttonWidth - 2 * graphButtonWidth - 3 * padding);
+    if (ImGui::Button("Load Graph", ImVec2(graphButtonWidth, 0))) {
+        loadGraphFile();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save Graph", ImVec2(graphButtonWidth, 0))) {
+        saveGraphFile();
+    }
+
     ImGui::SameLine();
     // Set the cursor position X to (window width - button width)
     ImGui::SetCursorPosX(windowWidth - buttonWidth - padding);
@@ -181,46 +238,7 @@ void Editor::showPipelineView() {
         if (ed::QueryNewLink(&link.startPin, &link.endPin)) {
             if (link.startPin != link.endPin && ed::AcceptNewItem()) {
                 link.id = currentId++;
-
-                Node* startNode = nullptr;
-                Node* endNode = nullptr;
-                PinType startPinType = PinType::Unknown, endPinType = PinType::Unknown;
-
-                for (const auto& node : nodes) {
-                    for (const auto& pin : node->outputPins) {
-                        if (pin.id == link.startPin) {
-                            startNode = node.get();
-                            startPinType = pin.type;
-                        }
-                    }
-                    for (const auto& pin : node->inputPins) {
-                        if (pin.id == link.endPin) {
-                            endNode = node.get();
-                            endPinType = pin.type;
-                        }
-                    }
-                }
-
-                if (startNode && endNode) {
-                    startNode->addLink(link);
-                    endNode->addLink(link);
-                    links.push_back(link);
-
-                    if (auto modelNode = dynamic_cast<ModelNode*>(startNode)) {
-                        if (auto pipelineNode = dynamic_cast<PipelineNode*>(endNode)) {
-                        	pipelineNode->setModel(modelNode);
-                            if (startPinType == PinType::VertexOutput && endPinType == PinType::VertexInput) {
-                                pipelineNode->setVertexDataInput(modelNode);
-                            }
-                            if (startPinType == PinType::ColorOutput && endPinType == PinType::ColorInput) {
-                                pipelineNode->setColorDataInput(modelNode);
-                            }
-                            if (startPinType == PinType::TextureOutput && endPinType == PinType::TextureInput) {
-                                pipelineNode->setTextureDataInput(modelNode);
-                            }
-                        }
-                    }
-                }
+                connectLink(nodes, links, link);
             }
         }
     }
@@ -298,12 +316,31 @@ void Editor::showModelView() {
     ImGui::InputText("##textureFile", selectedModelNode->texturePath, IM_ARRAYSIZE(selectedModelNode->texturePath));
     ImGui::SameLine();
     if (ImGui::Button("...##Texture")) {
-        const char* filter[] = { "*.png", "*.jpg", "*.jpeg", "*.tga", "*.bmp", "*.dds", "*.*" }; // Texture file filters
-        const char* selectedPath = tinyfd_openFileDialog("Select Texture File", "", 7, filter, "Texture Files", 0);
+        const char* filter[] = { "*.png", "*.jpg", "*.jpeg", "*.tga", "*.bmp", "*.dds", "*.ktx2", "*.*" }; // Texture file filters
+        const char* selectedPath = tinyfd_openFileDialog("Select Texture File", "", 8, filter, "Texture Files", 0);
         if (selectedPath) {
             strncpy(selectedModelNode->texturePath, selectedPath, IM_ARRAYSIZE(selectedModelNode->texturePath));
         }
     }
+    ImGui::Checkbox("Generate Mipmaps", &selectedModelNode->generateMipmaps);
+    ImGui::Checkbox("Compressed Textures", &selectedModelNode->compressedTextures);
+    ImGui::Checkbox("Asynchronous Loading", &selectedModelNode->asyncLoading);
+    ImGui::Checkbox("Memory Mapped Textures", &selectedModelNode->mappedTextures);
+    ImGui::Checkbox("Texture Cache", &selectedModelNode->textureCache);
+    ImGui::Checkbox("Bindless Textures", &selectedModelNode->bindlessTextures);
+    ImGui::Checkbox("Shared Object Data", &selectedModelNode->sharedObjectData);
+
+    ImGui::Checkbox("Fast Vertex Dedup", &selectedModelNode->fastVertexDedup);
+    ImGui::Checkbox("Parallel Loading", &selectedModelNode->parallelLoading);
+    ImGui::Checkbox("Cooked Mesh", &selectedModelNode->cookedMesh);
+    ImGui::Checkbox("Optimize Mesh", &selectedModelNode->optimizeMesh);
+    ImGui::Checkbox("16 Bit Indices", &selectedModelNode->shortIndices);
+    ImGui::Checkbox("Geometry Arena", &selectedModelNode->geometryArena);
+    ImGui::Checkbox("Batched Uploads", &selectedModelNode->batchedUploads);
+
+    ImGui::Combo("Position Format", &selectedModelNode->positionFormat, positionFormats.data(), positionFormats.size());
+    ImGui::Combo("Color Format", &selectedModelNode->colorFormat, colorFormats.data(), colorFormats.size());
+    ImGui::Combo("UV Format", &selectedModelNode->texCoordFormat, texCoordFormats.data(), texCoordFormats.size());
 }
 
 void Editor::startEditor() {
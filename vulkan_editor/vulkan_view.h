@@ -22,6 +22,10 @@ public:
     std::vector<std::unique_ptr<Node>> nodes;
     std::vector<Link> links;
     int currentId = 1;
+    // Writes generated/ with the third party implementations in their own TU and a meson.build
+    bool splitOutput = false;
+    // Prints per template render timings after each generation and writes them to generation_profile.json
+    bool profileGeneration = false;
 
     TemplateLoader templateLoader = {};
 
@@ -31,6 +35,8 @@ public:
     void nodeEditorInitialize();
 
     void saveFile();
+    void saveGraphFile();
+    void loadGraphFile();
 
     void showModelView();
 
@@ -0,0 +1,633 @@
+// Mesh loading stages shared by the editor and the generated renderer. The editor includes this file, the generator
+// renders it as a template without data and pastes it after the Vertex struct, so it must stay free of inja delimiters.
+// Vertex is any type with indexable pos, color and texCoord members and no padding.
+// A guard rather than #pragma once, which warns in the main file of the generated renderer.
+#ifndef GVE_MESH_LOADER_H
+#define GVE_MESH_LOADER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace gve {
+
+// Open addressing map from vertex bytes to vertex index, one probe sequence per index
+template<typename Vertex>
+struct VertexDedupMap {
+    std::vector<uint32_t> slots;    // vertex index + 1, 0 marks an empty slot
+    size_t mask = 0;
+    size_t count = 0;
+
+    explicit VertexDedupMap(size_t expected) {
+        size_t capacity = 16;
+        while (capacity < expected + expected / 2) capacity <<= 1;
+        slots.assign(capacity, 0);
+        mask = capacity - 1;
+    }
+
+    static uint64_t hashBytes(const Vertex& vertex) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        uint64_t hash = 0x9e3779b97f4a7c15ull;
+        size_t i = 0;
+        for (; i + 8 <= sizeof(Vertex); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, 8);
+            hash = (hash ^ (word * 0xff51afd7ed558ccdull)) * 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 32;
+        }
+        for (; i < sizeof(Vertex); i++) hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    void grow(const std::vector<Vertex>& vertices) {
+        slots.assign(slots.size() * 2, 0);
+        mask = slots.size() - 1;
+        for (uint32_t i = 0; i < vertices.size(); i++) {
+            size_t slot = hashBytes(vertices[i]) & mask;
+            while (slots[slot] != 0) slot = (slot + 1) & mask;
+            slots[slot] = i + 1;
+        }
+    }
+
+    // Index of an equal vertex, or of vertex appended to vertices
+    uint32_t findOrInsert(const Vertex& vertex, std::vector<Vertex>& vertices) {
+        if ((count + 1) * 4 > slots.size() * 3) grow(vertices);
+        for (size_t slot = hashBytes(vertex) & mask;; slot = (slot + 1) & mask) {
+            uint32_t stored = slots[slot];
+            if (stored == 0) {
+                vertices.push_back(vertex);
+                slots[slot] = static_cast<uint32_t>(vertices.size());
+                count++;
+                return static_cast<uint32_t>(vertices.size() - 1);
+            }
+            if (std::memcmp(&vertices[stored - 1], &vertex, sizeof(Vertex)) == 0) return stored - 1;
+        }
+    }
+};
+
+// The vertex every loader builds from an OBJ corner, texcoord is null when the corner has none
+template<typename Vertex>
+Vertex makeObjVertex(const float* position, const float* texcoord) {
+    Vertex vertex{};
+    vertex.pos[0] = position[0];
+    vertex.pos[1] = position[1];
+    vertex.pos[2] = position[2];
+    if (texcoord) {
+        vertex.texCoord[0] = texcoord[0];
+        vertex.texCoord[1] = 1.0f - texcoord[1];
+    }
+    vertex.color[0] = vertex.color[1] = vertex.color[2] = 1.0f;
+    return vertex;
+}
+
+// One line aligned part of the OBJ file and what it turns into
+template<typename Vertex>
+struct ObjChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<float> positions;
+    std::vector<float> texcoords;
+    std::vector<int> corners;               // position, texcoord pairs of the triangulated faces, 0 based
+    std::vector<size_t> relativeCorners;    // entries of corners that count from this chunk's first v or vt line
+    size_t positionOffset = 0;
+    size_t texcoordOffset = 0;
+    size_t indexOffset = 0;
+    std::vector<Vertex> vertices;           // unique within the chunk
+    std::vector<uint32_t> indices;          // into vertices
+    std::vector<uint32_t> remap;            // chunk vertex to mesh vertex
+    bool failed = false;
+};
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+inline void parseFloats(const char* p, const char* end, int count, std::vector<float>& out) {
+    for (int i = 0; i < count; i++) {
+        float value = 0.0f;
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+') p++;
+        p = std::from_chars(p, end, value).ptr;
+        out.push_back(value);
+    }
+}
+
+// OBJ indices are 1 based, negative ones count back from the last v or vt line read so far
+inline void addCorner(int value, size_t readCount, std::vector<int>& face, std::vector<char>& relative) {
+    relative.push_back(value < 0);
+    face.push_back(value > 0 ? value - 1 : value < 0 ? static_cast<int>(readCount) + value : -1);
+}
+
+template<typename Vertex>
+void parseChunk(ObjChunk<Vertex>& chunk) {
+    std::vector<int> face;
+    std::vector<char> relative;
+    const char* end = chunk.end;
+    for (const char* p = chunk.begin; p < end;) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        p = skipSpaces(p, lineEnd);
+
+        if (lineEnd - p > 2 && p[0] == 'v' && p[1] == ' ') {
+            parseFloats(p + 2, lineEnd, 3, chunk.positions);
+        } else if (lineEnd - p > 3 && p[0] == 'v' && p[1] == 't' && p[2] == ' ') {
+            parseFloats(p + 3, lineEnd, 2, chunk.texcoords);
+        } else if (lineEnd - p > 2 && p[0] == 'f' && p[1] == ' ') {
+            face.clear();
+            relative.clear();
+            const char* q = p + 2;
+            while ((q = skipSpaces(q, lineEnd)) < lineEnd && *q != '\r') {
+                int position = 0, texcoord = 0, normal = 0;
+                q = std::from_chars(q, lineEnd, position).ptr;
+                if (q < lineEnd && *q == '/') {
+                    q = std::from_chars(q + 1, lineEnd, texcoord).ptr;
+                    if (q < lineEnd && *q == '/') q = std::from_chars(q + 1, lineEnd, normal).ptr;
+                }
+                if (position == 0) break;
+                addCorner(position, chunk.positions.size() / 3, face, relative);
+                addCorner(texcoord, chunk.texcoords.size() / 2, face, relative);
+                while (q < lineEnd && *q != ' ' && *q != '\t') q++;
+            }
+
+            // Polygons become a fan of triangles
+            for (size_t k = 1; k + 1 < face.size() / 2; k++) {
+                for (size_t corner : { size_t(0), k, k + 1 }) {
+                    for (size_t entry = corner * 2; entry < corner * 2 + 2; entry++) {
+                        if (relative[entry]) chunk.relativeCorners.push_back(chunk.corners.size());
+                        chunk.corners.push_back(face[entry]);
+                    }
+                }
+            }
+        }
+        p = lineEnd + 1;
+    }
+}
+
+template<typename Vertex>
+void dedupChunk(ObjChunk<Vertex>& chunk, const std::vector<float>& positions, const std::vector<float>& texcoords) {
+    for (size_t entry : chunk.relativeCorners) {
+        chunk.corners[entry] += static_cast<int>(entry % 2 == 0 ? chunk.positionOffset : chunk.texcoordOffset);
+    }
+
+    size_t positionCount = positions.size() / 3;
+    size_t texcoordCount = texcoords.size() / 2;
+    VertexDedupMap<Vertex> uniqueVertices{chunk.corners.size() / 2};
+    chunk.indices.reserve(chunk.corners.size() / 2);
+    for (size_t i = 0; i < chunk.corners.size(); i += 2) {
+        int position = chunk.corners[i];
+        int texcoord = chunk.corners[i + 1];
+        if (position < 0 || static_cast<size_t>(position) >= positionCount || texcoord >= static_cast<int>(texcoordCount)) {
+            chunk.failed = true;
+            return;
+        }
+
+        Vertex vertex = makeObjVertex<Vertex>(&positions[3 * position], texcoord >= 0 ? &texcoords[2 * texcoord] : nullptr);
+        chunk.indices.push_back(uniqueVertices.findOrInsert(vertex, chunk.vertices));
+    }
+    std::vector<int>().swap(chunk.corners);
+}
+
+template<typename Vertex, typename Function>
+void forEachChunk(std::vector<ObjChunk<Vertex>>& chunks, Function function) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunks.size(); i++) threads.emplace_back(function, std::ref(chunks[i]));
+    function(chunks[0]);
+    for (auto& thread : threads) thread.join();
+}
+
+// Up to threadCount chunks parse and deduplicate on their own threads, then merge in file order so vertices keep the
+// order of their first use like in the serial loader
+template<typename Vertex>
+void loadObjParallel(const std::string& fileName, unsigned threadCount, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open " + fileName);
+    }
+    std::vector<char> text(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(text.data(), text.size());
+
+    // Chunks of at least a megabyte, smaller ones cost more in threads than they save
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, text.size() >> 20));
+    std::vector<ObjChunk<Vertex>> chunks(chunkCount);
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char* chunkEnd = std::max<const char*>(begin, text.data() + text.size() * (i + 1) / chunkCount);
+        const char* lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+        chunkEnd = (i + 1 == chunkCount || !lineEnd) ? end : lineEnd + 1;
+        chunks[i].begin = begin;
+        chunks[i].end = chunkEnd;
+        begin = chunkEnd;
+    }
+
+    forEachChunk(chunks, parseChunk<Vertex>);
+
+    std::vector<float> positions, texcoords;
+    size_t positionCount = 0, texcoordCount = 0;
+    for (auto& chunk : chunks) {
+        chunk.positionOffset = positionCount;
+        chunk.texcoordOffset = texcoordCount;
+        positionCount += chunk.positions.size() / 3;
+        texcoordCount += chunk.texcoords.size() / 2;
+    }
+    positions.resize(positionCount * 3);
+    texcoords.resize(texcoordCount * 2);
+    forEachChunk(chunks, [&positions, &texcoords](ObjChunk<Vertex>& chunk) {
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionOffset * 3);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + chunk.texcoordOffset * 2);
+        std::vector<float>().swap(chunk.positions);
+        std::vector<float>().swap(chunk.texcoords);
+    });
+
+    forEachChunk(chunks, [&positions, &texcoords](ObjChunk<Vertex>& chunk) { dedupChunk(chunk, positions, texcoords); });
+
+    size_t chunkVertexCount = 0, indexCount = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.failed) {
+            throw std::runtime_error("face index out of range in " + fileName);
+        }
+        chunkVertexCount += chunk.vertices.size();
+        chunk.indexOffset = indexCount;
+        indexCount += chunk.indices.size();
+    }
+
+    vertices.clear();
+    indices.resize(indexCount);
+    VertexDedupMap<Vertex> uniqueVertices{chunkVertexCount};
+    for (auto& chunk : chunks) {
+        chunk.remap.reserve(chunk.vertices.size());
+        for (const Vertex& vertex : chunk.vertices) chunk.remap.push_back(uniqueVertices.findOrInsert(vertex, vertices));
+    }
+
+    forEachChunk(chunks, [&indices](ObjChunk<Vertex>& chunk) {
+        for (size_t i = 0; i < chunk.indices.size(); i++) indices[chunk.indexOffset + i] = chunk.remap[chunk.indices[i]];
+    });
+}
+
+// Header of <model>.gvemesh, the deduplicated mesh of an OBJ followed by the vertex and index blobs
+struct CookedMeshHeader {
+    char magic[4];          // "GVEM"
+    uint32_t version;
+    uint32_t vertexSize;    // sizeof(Vertex) of the loader that cooked it
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t flags;         // cookedMeshOptimized when optimizeMesh ran before cooking
+    uint64_t sourceSize;
+    int64_t sourceTime;     // last write time of the OBJ, checked before the hash
+    uint64_t sourceHash;    // FNV-1a of the OBJ contents
+};
+
+constexpr uint32_t cookedMeshVersion = 1;
+constexpr uint32_t cookedMeshOptimized = 1;
+
+inline std::string cookedMeshPath(const std::string& modelPath) {
+    return modelPath + ".gvemesh";
+}
+
+inline uint64_t hashFileContents(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    uint64_t hash = 14695981039346656037ull;
+    std::vector<char> buffer(1 << 16);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+inline bool sourceStat(const std::string& fileName, uint64_t& size, int64_t& time) {
+    std::error_code error;
+    size = std::filesystem::file_size(fileName, error);
+    if (error) return false;
+    time = std::filesystem::last_write_time(fileName, error).time_since_epoch().count();
+    return !error;
+}
+
+// Opens the cooked mesh of modelPath read only and leaves it positioned after the header, false when it is missing, stale,
+// cooked with other flags or shorter or longer than its counts say. The renderer never writes it back: an OBJ touched
+// with unchanged contents is hashed on every load until the editor's cook step rewrites the cooked mesh with its new time.
+template<typename Vertex>
+bool openCookedMesh(const std::string& modelPath, uint32_t flags, std::ifstream& file, CookedMeshHeader& header) {
+    std::string cookedPath = cookedMeshPath(modelPath);
+    std::error_code error;
+    uint64_t cookedSize = std::filesystem::file_size(cookedPath, error);
+    if (error || cookedSize < sizeof(header)) return false;
+
+    file.open(cookedPath, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, "GVEM", 4) != 0 || header.version != cookedMeshVersion || header.vertexSize != sizeof(Vertex) ||
+        header.flags != flags) {
+        return false;
+    }
+    // 32 bit counts times small element sizes cannot overflow 64 bits
+    if (cookedSize != sizeof(header) + uint64_t(header.vertexCount) * sizeof(Vertex) + uint64_t(header.indexCount) * sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!sourceStat(modelPath, sourceSize, sourceTime) || sourceSize != header.sourceSize) return false;
+    return sourceTime == header.sourceTime || hashFileContents(modelPath) == header.sourceHash;
+}
+
+// Reads the blobs straight into vertices and indices when the cooked mesh belongs to the current OBJ.
+// Read rather than mapped: the vectors are what packing, the geometry arena and the staging upload consume, so a
+// mapping would only swap this read for a memcpy of the same bytes.
+template<typename Vertex>
+bool loadCookedMesh(const std::string& modelPath, uint32_t flags, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::ifstream file;
+    CookedMeshHeader header{};
+    if (!openCookedMesh<Vertex>(modelPath, flags, file, header)) return false;
+
+    vertices.resize(header.vertexCount);
+    indices.resize(header.indexCount);
+    file.read(reinterpret_cast<char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+    file.read(reinterpret_cast<char*>(indices.data()), indices.size() * sizeof(uint32_t));
+    if (!file) {
+        vertices.clear();
+        indices.clear();
+        return false;
+    }
+    return true;
+}
+
+// Written aside and renamed, so a crash or a renderer starting meanwhile never sees a half written cooked mesh
+template<typename Vertex>
+bool writeCookedMesh(const std::string& modelPath, uint32_t flags, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    CookedMeshHeader header{};
+    std::memcpy(header.magic, "GVEM", 4);
+    header.version = cookedMeshVersion;
+    header.flags = flags;
+    header.vertexSize = sizeof(Vertex);
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.sourceHash = hashFileContents(modelPath);
+    if (!sourceStat(modelPath, header.sourceSize, header.sourceTime)) return false;
+
+    std::string cookedPath = cookedMeshPath(modelPath);
+    std::string tempPath = cookedPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+        if (!file) return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, cookedPath, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+// Forsyth's vertex scores for a 32 entry LRU cache
+inline constexpr size_t optimizerCacheSize = 32;
+
+inline float vertexScore(int cachePosition, uint32_t liveTriangles) {
+    if (liveTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // The last triangle's vertices get a fixed score so the next one does not just reuse its edge
+        score = cachePosition < 3 ? 0.75f : std::pow(1.0f - (cachePosition - 3) / float(optimizerCacheSize - 3), 1.5f);
+    }
+    return score + 2.0f / std::sqrt(float(liveTriangles));
+}
+
+inline void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles of each vertex, the live ones first
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) liveTriangles[index]++;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) vertexScores[v] = vertexScore(-1, liveTriangles[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache, nextCache;
+    size_t cursor = 0;
+    size_t best = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+
+    while (result.size() < indices.size()) {
+        if (best == triangleCount) {
+            // Nothing in the cache has triangles left, continue with the next one in input order
+            while (emitted[cursor]) cursor++;
+            best = cursor;
+        }
+
+        emitted[best] = 1;
+        const uint32_t* triangle = &indices[3 * best];
+        result.insert(result.end(), triangle, triangle + 3);
+
+        nextCache.assign(triangle, triangle + 3);
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = triangle[corner];
+            uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+            uint32_t* last = begin + --liveTriangles[v];
+            std::swap(*std::find(begin, last + 1, static_cast<uint32_t>(best)), *last);
+        }
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) nextCache.push_back(v);
+        }
+
+        // Evicted vertices stay in nextCache until their score is updated, then drop out
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            uint32_t v = nextCache[i];
+            cachePositions[v] = i < optimizerCacheSize ? static_cast<int>(i) : -1;
+            vertexScores[v] = vertexScore(cachePositions[v], liveTriangles[v]);
+        }
+
+        float bestScore = -1.0f;
+        best = triangleCount;
+        for (uint32_t v : nextCache) {
+            for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v] + liveTriangles[v]; i++) {
+                uint32_t t = adjacency[i];
+                float score = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+                triangleScores[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > optimizerCacheSize) nextCache.resize(optimizerCacheSize);
+        std::swap(cache, nextCache);
+    }
+
+    indices.swap(result);
+}
+
+// Cache misses of one triangle in a FIFO of optimizerCacheSize vertices, the way Tipsify simulates it.
+// A vertex is cached while fewer than optimizerCacheSize misses happened since it was loaded.
+inline uint32_t fifoCacheMisses(const uint32_t* triangle, std::vector<uint32_t>& loadedAt, uint32_t& clock) {
+    uint32_t misses = 0;
+    for (int corner = 0; corner < 3; corner++) {
+        uint32_t& loaded = loadedAt[triangle[corner]];
+        if (clock - loaded > optimizerCacheSize) {
+            loaded = clock++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+// A cluster may end once its ACMR is within this factor of its hard cluster's
+inline constexpr float overdrawAcmrThreshold = 1.05f;
+
+// Tipsify's overdraw pass: the cache ordered triangles are cut where the order jumps to a triangle with three new
+// vertices, and each such run again wherever the ACMR since the last cut is within overdrawAcmrThreshold of the run's.
+// Clusters facing away from the mesh center go first, they are the likeliest to occlude the rest.
+template<typename Vertex>
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    std::vector<uint32_t> loadedAt(vertices.size(), 0);
+    uint32_t clock = optimizerCacheSize + 1;
+    std::vector<size_t> hardStarts;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (fifoCacheMisses(&indices[3 * t], loadedAt, clock) == 3) hardStarts.push_back(t);
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Every cut empties the simulated cache, so a cluster pays for its own vertices wherever it ends up
+    auto resetCache = [&clock] { clock += optimizerCacheSize + 1; };
+    std::vector<size_t> clusterStarts;
+    for (size_t h = 0; h + 1 < hardStarts.size(); h++) {
+        size_t begin = hardStarts[h], end = hardStarts[h + 1];
+        resetCache();
+        uint32_t misses = 0;
+        for (size_t t = begin; t < end; t++) misses += fifoCacheMisses(&indices[3 * t], loadedAt, clock);
+        float threshold = overdrawAcmrThreshold * misses / float(end - begin);
+
+        clusterStarts.push_back(begin);
+        resetCache();
+        misses = 0;
+        for (size_t t = begin; t < end; t++) {
+            misses += fifoCacheMisses(&indices[3 * t], loadedAt, clock);
+            if (t + 1 < end && misses <= threshold * float(t + 1 - clusterStarts.back())) {
+                clusterStarts.push_back(t + 1);
+                resetCache();
+                misses = 0;
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    struct Cluster {
+        size_t begin, end;
+        float center[3];
+        float normal[3];
+        float area;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (size_t c = 0; c + 1 < clusterStarts.size(); c++) {
+        Cluster cluster{ clusterStarts[c], clusterStarts[c + 1], { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 0.0f, 0.0f };
+        for (size_t t = cluster.begin; t < cluster.end; t++) {
+            const auto& a = vertices[indices[3 * t]].pos;
+            const auto& b = vertices[indices[3 * t + 1]].pos;
+            const auto& p = vertices[indices[3 * t + 2]].pos;
+            float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+            float normal[3] = { ab[1] * ap[2] - ab[2] * ap[1], ab[2] * ap[0] - ab[0] * ap[2], ab[0] * ap[1] - ab[1] * ap[0] };
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int k = 0; k < 3; k++) {
+                cluster.center[k] += (a[k] + b[k] + p[k]) / 3.0f * area;
+                cluster.normal[k] += normal[k];
+            }
+            cluster.area += area;
+        }
+        for (int k = 0; k < 3; k++) meshCenter[k] += cluster.center[k];
+        meshArea += cluster.area;
+        if (cluster.area > 0.0f) {
+            for (int k = 0; k < 3; k++) cluster.center[k] /= cluster.area;
+        }
+        clusters.push_back(cluster);
+    }
+    if (meshArea > 0.0f) {
+        for (int k = 0; k < 3; k++) meshCenter[k] /= meshArea;
+    }
+
+    for (Cluster& cluster : clusters) {
+        float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+        cluster.sortKey = 0.0f;
+        if (length > 0.0f) {
+            for (int k = 0; k < 3; k++) cluster.sortKey += (cluster.center[k] - meshCenter[k]) * cluster.normal[k] / length;
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+    }
+    indices.swap(result);
+}
+
+// Renumbers vertices in order of first use, so the vertex buffer is read front to back. Unused vertices are dropped.
+template<typename Vertex>
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+    for (uint32_t& index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = static_cast<uint32_t>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+// Triangles reordered for the post-transform vertex cache (Forsyth), then split into clusters that keep its ACMR and
+// sorted outside in against overdraw (Tipsify), then vertices in the order they are fetched
+template<typename Vertex>
+void optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+}
+
+}
+
+#endif